@@ -0,0 +1,205 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+/*  Measures the cost of looking up a stored object by type.
+
+    Each run registers N distinct types, then performs
+    lookups in a pseudo-random order. The polystore is
+    compared against a std::unordered_map keyed by type,
+    which is how polystore::find was implemented before
+    the flat index. Both the type-erased lookup, which
+    goes through the flat index, and the templated lookup,
+    which indexes by type slot, are measured, as well as
+    the type-erased lookup after the container is sealed.
+*/
+
+#include <boost/rts/polystore.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+template<std::size_t I>
+struct svc
+{
+    char buf[16];
+};
+
+struct hasher
+{
+    std::size_t operator()(
+        detail::typeindex const& t) const noexcept
+    {
+        return t.hash_code();
+    }
+};
+
+using map_type = std::unordered_map<
+    detail::typeindex, void*, hasher>;
+
+struct entry
+{
+    core::typeinfo const* ti;
+    void (*emplace)(polystore&, map_type&);
+    void* (*find_ps)(polystore const&);
+    void* (*find_ti)(polystore const&);
+    void* (*find_map)(map_type const&);
+};
+
+template<std::size_t I>
+void do_emplace(polystore& ps, map_type& m)
+{
+    m.emplace(BOOST_CORE_TYPEID(svc<I>),
+        &ps.emplace<svc<I>>());
+}
+
+template<std::size_t I>
+void* do_find_ps(polystore const& ps)
+{
+    return ps.find<svc<I>>();
+}
+
+template<std::size_t I>
+void* do_find_ti(polystore const& ps)
+{
+    return ps.find(BOOST_CORE_TYPEID(svc<I>));
+}
+
+template<std::size_t I>
+void* do_find_map(map_type const& m)
+{
+    auto it = m.find(BOOST_CORE_TYPEID(svc<I>));
+    return it != m.end() ? it->second : nullptr;
+}
+
+// Appends entries for svc<B> through svc<B+N-1>,
+// splitting in halves to keep instantiation depth low
+template<std::size_t B, std::size_t N>
+struct make_entries
+{
+    static void apply(std::vector<entry>& v)
+    {
+        make_entries<B, N / 2>::apply(v);
+        make_entries<B + N / 2, N - N / 2>::apply(v);
+    }
+};
+
+template<std::size_t B>
+struct make_entries<B, 1>
+{
+    static void apply(std::vector<entry>& v)
+    {
+        v.push_back({ &BOOST_CORE_TYPEID(svc<B>),
+            &do_emplace<B>, &do_find_ps<B>,
+            &do_find_ti<B>, &do_find_map<B> });
+    }
+};
+
+std::vector<std::size_t>
+make_order(std::size_t n, std::size_t count)
+{
+    std::vector<std::size_t> v;
+    v.reserve(count);
+    std::uint32_t x = 2463534242u;
+    while(v.size() < count)
+    {
+        // xorshift32
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        v.push_back(x % n);
+    }
+    return v;
+}
+
+template<class F>
+double
+measure(
+    std::vector<std::size_t> const& order,
+    std::size_t rounds,
+    F const& f)
+{
+    using clock = std::chrono::steady_clock;
+    std::uintptr_t sink = 0;
+    auto const t0 = clock::now();
+    for(std::size_t r = 0; r < rounds; ++r)
+        for(auto i : order)
+            sink += reinterpret_cast<
+                std::uintptr_t>(f(i));
+    auto const t1 = clock::now();
+    if(sink == 1)
+        std::puts("");
+    return std::chrono::duration<double, std::nano>(
+        t1 - t0).count() / (rounds * order.size());
+}
+
+void
+run(std::vector<entry> const& all, std::size_t n)
+{
+    polystore ps;
+    map_type m;
+    for(std::size_t i = 0; i < n; ++i)
+        all[i].emplace(ps, m);
+
+    auto const order = make_order(n, 4096);
+    std::size_t const rounds = 2000;
+
+    auto const t_map = measure(order, rounds,
+        [&](std::size_t i)
+        {
+            return all[i].find_map(m);
+        });
+    auto const t_ti = measure(order, rounds,
+        [&](std::size_t i)
+        {
+            return all[i].find_ti(ps);
+        });
+    auto const t_ps = measure(order, rounds,
+        [&](std::size_t i)
+        {
+            return all[i].find_ps(ps);
+        });
+    ps.seal();
+    auto const t_sealed = measure(order, rounds,
+        [&](std::size_t i)
+        {
+            return all[i].find_ti(ps);
+        });
+
+    std::printf(
+        "%5u services: unordered_map %6.2f ns, "
+        "find(typeinfo) %6.2f ns, sealed %6.2f ns, "
+        "find<T> %6.2f ns\n",
+        static_cast<unsigned>(n), t_map, t_ti,
+        t_sealed, t_ps);
+}
+
+} // (anon)
+
+} // rts
+} // boost
+
+int
+main()
+{
+    using namespace boost::rts;
+    std::vector<entry> all;
+    make_entries<0, 1000>::apply(all);
+    run(all, 10);
+    run(all, 100);
+    run(all, 1000);
+    return EXIT_SUCCESS;
+}
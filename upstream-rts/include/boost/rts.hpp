@@ -11,6 +11,13 @@
 #define BOOST_RTS_HPP
 
 #include <boost/rts/application.hpp>
+#include <boost/rts/bind.hpp>
+#include <boost/rts/concurrent_polystore.hpp>
+#include <boost/rts/error.hpp>
+#include <boost/rts/per_core.hpp>
+#include <boost/rts/per_thread.hpp>
 #include <boost/rts/polystore.hpp>
+#include <boost/rts/snapshot_polystore.hpp>
+#include <boost/rts/static_polystore.hpp>
 
 #endif
@@ -26,6 +26,11 @@ namespace rts {
     `start()` on each part. When @ref stop is called, each part has its
     `stop()` member invoked. And when the application object is destroyed,
     all the parts are destroyed in reverse order of construction.
+
+    A part registered with @ref polystore::register_factory takes its
+    place in that order when it is made. A part made while @ref start
+    runs is started after the parts made before it; one made after
+    @ref start returns is not started, but is stopped with the others.
 */
 class BOOST_SYMBOL_VISIBLE
     application : public rts::polystore
@@ -46,9 +51,27 @@ public:
     BOOST_RTS_DECL
     application();
 
+    /** Constructor
+
+        The parts, the internal storage of the container and
+        the state of the application are obtained from `mr`,
+        which must outlive the application.
+
+        @param mr The memory resource to use, or `nullptr`
+            to use the global heap.
+    */
+    BOOST_RTS_DECL
+    explicit
+    application(
+        container::pmr::memory_resource* mr);
+
     /** Invoke `start` on each part in creation order
         Each call is performed synchronously; this function blocks until each
         part returns. Only one invocation of `start` is permitted.
+        When every part has started, the application is sealed (see
+        @ref polystore::seal) and no further parts may be added.
+        If a part throws, the parts already started are stopped in
+        reverse order and the exception is propagated.
     */
     BOOST_RTS_DECL
     void start();
@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_BIND_HPP
+#define BOOST_RTS_BIND_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/call_traits.hpp>
+#include <boost/rts/detail/type_traits.hpp>
+#include <boost/rts/polystore.hpp>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace rts {
+
+namespace detail {
+
+// an argument looked up once
+template<class T> struct bound_arg;
+template<class T> struct bound_arg<T const&> : bound_arg<T&> {};
+template<class T> struct bound_arg<T const*> : bound_arg<T*> {};
+template<class T> struct bound_arg<T&>
+{
+    T* p = nullptr;
+
+    void resolve(polystore& ps)
+    {
+        p = &ps.get<T>();
+    }
+
+    T& get() const noexcept
+    {
+        return *p;
+    }
+};
+template<class T> struct bound_arg<T*>
+{
+    T* p = nullptr;
+
+    void resolve(polystore& ps)
+    {
+        p = ps.find<T>();
+    }
+
+    T* get() const noexcept
+    {
+        return p;
+    }
+};
+
+template<class ArgList> struct bound_args;
+template<class... Args>
+struct bound_args<type_list<Args...>>
+{
+    using indices = make_index_sequence<sizeof...(Args)>;
+
+    std::tuple<bound_arg<Args>...> t;
+
+    void
+    resolve(polystore& ps)
+    {
+        resolve(ps, indices{});
+    }
+
+    template<class F>
+    auto
+    call(F& f) const ->
+        typename call_traits<F>::return_type
+    {
+        return call(f, indices{});
+    }
+
+private:
+    template<std::size_t... Is>
+    void
+    resolve(polystore& ps, index_sequence<Is...>)
+    {
+        // braced lists are evaluated in order
+        int const v[] = { 0, (
+            std::get<Is>(t).resolve(ps), 0)... };
+        (void)v;
+    }
+
+    template<class F, std::size_t... Is>
+    auto
+    call(F& f, index_sequence<Is...>) const ->
+        typename call_traits<F>::return_type
+    {
+        return f(std::get<Is>(t).get()...);
+    }
+};
+
+} // detail
+
+/** A callable whose arguments were looked up in advance
+
+    Objects of this type are returned by @ref bind. Each
+    argument of the wrapped callable is looked up in a
+    @ref polystore once, when the object is created or
+    rebound, and the resulting pointers are kept. Calls
+    then pass the kept objects without any lookup and
+    without throwing `std::bad_typeid`.
+
+    Insertion never moves stored objects, so the kept
+    pointers stay valid while the objects remain in the
+    container. If the container is cleared, moved from,
+    or otherwise changes in a way that matters to the
+    callable, call @ref rebind before the next call.
+
+    @tparam F The decayed type of the callable.
+*/
+template<class F>
+class bound_call
+{
+    using traits = detail::call_traits<F>;
+
+public:
+    /** The type returned by the callable
+    */
+    using result_type = typename traits::return_type;
+
+    /** Constructor
+
+        The arguments of `f` are looked up in `ps`.
+        Reference arguments must be present; pointer
+        arguments which are not present are passed
+        as `nullptr`.
+
+        @throws std::bad_typeid if any reference argument
+            types are not found in the container.
+        @param ps The container to look up arguments in.
+        @param f The callable to wrap.
+    */
+    template<class F_>
+    bound_call(polystore& ps, F_&& f)
+        : f_(std::forward<F_>(f))
+    {
+        a_.resolve(ps);
+    }
+
+    /** Look up the arguments again
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @throws std::bad_typeid if any reference argument
+            types are not found in the container.
+        @param ps The container to look up arguments in.
+    */
+    void
+    rebind(polystore& ps)
+    {
+        auto a = a_;
+        a.resolve(ps);
+        a_ = a;
+    }
+
+    /** Invoke the callable with the arguments looked up earlier
+
+        @return The result of the invocation.
+    */
+    result_type
+    operator()()
+    {
+        return a_.call(f_);
+    }
+
+private:
+    F f_;
+    detail::bound_args<typename traits::arg_types> a_;
+};
+
+/** Return a callable with its arguments looked up in advance
+
+    This performs the lookups of @ref invoke once, and
+    returns an object which calls `f` with the objects
+    found. Use it when the same callable is invoked many
+    times against the same container.
+
+    @par Example
+    @code
+    struct A { int i = 1; };
+    polystore ps;
+    ps.emplace<A>();
+    auto f = bind(ps, [](A& a){ return a.i; });
+    assert(f() == 1);
+    @endcode
+
+    @param ps The container to look up arguments in.
+    @param f The callable to wrap.
+    @return A @ref bound_call holding `f` and its arguments.
+    @throws std::bad_typeid if any reference argument
+        types are not found in the container.
+*/
+template<class F>
+bound_call<typename std::decay<F>::type>
+bind(polystore& ps, F&& f)
+{
+    return bound_call<typename std::decay<F>::type>(
+        ps, std::forward<F>(f));
+}
+
+} // rts
+} // boost
+
+#endif
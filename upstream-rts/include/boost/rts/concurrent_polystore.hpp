@@ -0,0 +1,307 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_CONCURRENT_POLYSTORE_HPP
+#define BOOST_RTS_CONCURRENT_POLYSTORE_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/polystore.hpp>
+#include <atomic>
+#include <mutex>
+
+namespace boost {
+namespace rts {
+
+/** A container of type-erased objects which supports concurrent insertion
+
+    This container offers the lookup and insertion interface of
+    @ref polystore, with the difference that every member function
+    may be called concurrently from any number of threads.
+
+    Lookups never block. The keys of the stored objects are
+    published through tables which are only ever replaced as a
+    whole, so a reader always sees either the old or the new
+    table, never a partially updated one. The tables are sized
+    in proportion to the number of keys, not to the number of
+    types used in the program. Replaced tables are kept until
+    the container is destroyed, since a reader may still be
+    using them; tables grow geometrically, so this at most
+    doubles their memory.
+
+    Insertions are serialized by a mutex. When several threads
+    race in @ref try_emplace or @ref use for the same type,
+    exactly one of them constructs the object and the others
+    receive a reference to it. Objects are constructed while the
+    mutex is held. The mutex is recursive, so a constructor may
+    itself insert other objects into the same container.
+
+    Objects are destroyed in the reverse order of construction
+    when the container is destroyed.
+
+    @par Example
+    @code
+    concurrent_polystore ps;
+
+    // on any thread
+    auto& cache = ps.use<feature_cache>();
+    invoke(ps, [](feature_cache& c) { c.touch(); });
+    @endcode
+
+    @see polystore
+*/
+class concurrent_polystore
+{
+public:
+    concurrent_polystore(concurrent_polystore const&) = delete;
+    concurrent_polystore& operator=(concurrent_polystore const&) = delete;
+
+    /** Destructor
+
+        All objects stored in the container are destroyed in
+        the reverse order of construction. No other member
+        function may be running on the same object.
+    */
+    BOOST_RTS_DECL
+    ~concurrent_polystore();
+
+    /** Constructor
+        The container is initially empty.
+    */
+    concurrent_polystore() = default;
+
+    /** Return a pointer to the object associated with type `T`, or `nullptr`
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor. Does not block.
+
+        @tparam T The type of object to find.
+        @return A pointer to the associated object, or `nullptr` if none exists.
+    */
+    template<class T>
+    T* find() const noexcept
+    {
+        auto const id = detail::type_slot<T>();
+        auto const t = slots_.load(std::memory_order_acquire);
+        if(t && id < t->size)
+            return static_cast<T*>(t->v[id].load(
+                std::memory_order_acquire));
+        return static_cast<T*>(find(BOOST_CORE_TYPEID(T)));
+    }
+
+    /** Return a pointer to the object associated with a type, or `nullptr`
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor. Does not block.
+
+        @param ti The type information of the key to find.
+        @return A pointer to the associated object, or `nullptr` if none exists.
+    */
+    BOOST_RTS_DECL
+    void*
+    find(core::typeinfo const& ti) const noexcept;
+
+    /** Return a reference to the object associated with type T
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor. Does not block.
+
+        @throws std::bad_typeid
+        If no object associated with type `T` is present.
+        @tparam T The type of object to retrieve.
+        @return A reference to the associated object.
+    */
+    template<class T>
+    T& get() const
+    {
+        if(auto t = find<T>())
+            return *t;
+        detail::throw_bad_typeid();
+    }
+
+    /** Construct and insert an object into the container
+
+        This has the same requirements and effects as
+        @ref polystore::emplace.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor.
+
+        @throws std::invalid_argument On duplicate insertion.
+        @tparam T The type of object to construct and insert.
+        @tparam Keys Optional key types associated with the object.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the inserted object.
+    */
+    template<class T, class... Keys, class... Args>
+    T& emplace(Args&&... args)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_);
+        return emplace_impl<T, Keys...>(
+            std::forward<Args>(args)...);
+    }
+
+    /** Return an existing object, creating it if necessary
+
+        This has the same requirements and effects as
+        @ref polystore::try_emplace. When several threads
+        call this function for the same type at once, only
+        one object is constructed and every caller receives
+        a reference to it.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor.
+
+        @throws std::invalid_argument On duplicate insertion.
+        @tparam T The type of object to return or create.
+        @tparam Keys Optional key types associated with the object.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the existing or newly created object.
+    */
+    template<class T, class... Keys, class... Args>
+    T& try_emplace(Args&&... args)
+    {
+        if(auto t = find<T>())
+            return *t;
+        std::lock_guard<std::recursive_mutex> lock(m_);
+        // another thread may have won the race
+        if(auto t = ps_.find<T>())
+            return *t;
+        return emplace_impl<T, Keys...>(
+            std::forward<Args>(args)...);
+    }
+
+    /** Insert an object by moving or copying it into the container
+
+        This has the same requirements and effects as
+        @ref polystore::insert.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor.
+
+        @throws std::invalid_argument On duplicate insertion.
+        @tparam T The type of object to insert.
+        @tparam Keys Optional key types associated with the object.
+        @param t The object to insert.
+        @return A reference to the stored object.
+    */
+    template<class T, class... Keys>
+    T& insert(T&& t)
+    {
+        return emplace<typename
+            std::remove_cv<T>::type, Keys...>(
+                std::forward<T>(t));
+    }
+
+    /** Return an existing object or create a new one
+
+        This has the same requirements and effects as
+        @ref polystore::use. When several threads call this
+        function for the same type at once, only one object
+        is constructed and every caller receives a reference
+        to it.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor.
+
+        @tparam T The type of object to retrieve or create.
+        @return A reference to the stored object.
+    */
+    template<class T>
+    T& use()
+    {
+        // T must be default constructible
+        BOOST_CORE_STATIC_ASSERT(
+            std::is_default_constructible<T>::value);
+        return try_emplace<T>();
+    }
+
+private:
+    struct slot_table
+    {
+        std::size_t size;
+        slot_table* prev;
+        std::atomic<void*>* v;
+    };
+
+    struct hash_table;
+
+    // slots below this always go in slot_table
+    static constexpr std::size_t min_direct = 32;
+
+    template<class T, class... Keys, class... Args>
+    T& emplace_impl(Args&&... args)
+    {
+        using keyset = polystore::keyset_t<T, Keys...>;
+        reserve(keyset::max_slot(), keyset::N);
+        auto& t = ps_.emplace<T, Keys...>(
+            std::forward<Args>(args)...);
+        keyset ks(t);
+        publish(BOOST_CORE_TYPEID(T), ks.kn, ks.N);
+        return t;
+    }
+
+    BOOST_RTS_DECL void reserve(
+        std::size_t max_slot, std::size_t n);
+    // erases the object of type ti from ps_ on failure
+    BOOST_RTS_DECL void publish(core::typeinfo const& ti,
+        polystore::key const* k, std::size_t n);
+
+    std::recursive_mutex m_;
+    polystore ps_;
+    std::atomic<slot_table*> slots_{ nullptr };
+    std::atomic<hash_table*> hash_{ nullptr };
+    std::size_t n_ = 0; // keys in hash_, guarded by m_
+    std::size_t limit_ = 0; // of slots_, guarded by m_
+};
+
+/** Invoke a callable, injecting stored objects as arguments
+
+    This has the same effects as the @ref polystore
+    overload. Lookups never block.
+
+    @param ps The container to take arguments from.
+    @param f The callable to invoke.
+    @return The result of the invocation.
+    @throws std::bad_typeid if any reference argument
+        types are not found in the container.
+*/
+template<class F>
+auto
+invoke(concurrent_polystore& ps, F&& f) ->
+    typename detail::call_traits<
+        typename std::decay<F>::type>::return_type
+{
+    return detail::invoke(ps, std::forward<F>(f),
+        typename detail::call_traits< typename
+            std::decay<F>::type>::arg_types{});
+}
+
+} // rts
+} // boost
+
+#endif
@@ -11,7 +11,11 @@
 #define BOOST_RTS_DATASTORE_HPP
 
 #include <boost/rts/detail/config.hpp>
+#include <boost/rts/per_thread.hpp>
 #include <boost/rts/polystore.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
 
 namespace boost {
 namespace rts {
@@ -21,10 +25,216 @@ class datastore : public polystore
 public:
     datastore() = default;
 
+    /** Constructor
+
+        All storage is obtained from `mr`, which must
+        outlive the datastore. For per-request data, a
+        monotonic buffer on the stack avoids the heap:
+        @code
+        char buf[2048];
+        container::pmr::monotonic_buffer_resource mr(buf, sizeof(buf));
+        datastore ds(&mr);
+        @endcode
+
+        @param mr The memory resource to use, or `nullptr`
+            to use the global heap.
+    */
+    explicit
+    datastore(
+        container::pmr::memory_resource* mr) noexcept
+        : polystore(mr)
+    {
+    }
+
+    /** Constructor
+
+        Lookups which find nothing in the datastore continue
+        in `parent`, which must outlive the datastore. Objects
+        emplaced in the datastore shadow those of the same
+        type in the parent. Nothing is allocated until the
+        first insertion, so a scope per request is cheap:
+        @code
+        datastore ds(&app);
+        ds.emplace<request_info>();
+        invoke(ds, [](request_info&, database& db){});
+        @endcode
+
+        @param parent The container to fall back to, or
+            `nullptr` for none.
+        @param mr The memory resource to use, or `nullptr`
+            to use the global heap.
+    */
+    explicit
+    datastore(
+        polystore const* parent,
+        container::pmr::memory_resource* mr = nullptr) noexcept
+        : polystore(parent, mr)
+    {
+    }
+
     void clear() noexcept  
     {
         polystore::clear();
     }
+
+    /** Remove and destroy all objects, keeping the storage
+
+        Objects are destroyed as by @ref clear, but the
+        memory of the datastore is kept for reuse. A
+        datastore which is reset and then filled with
+        the same objects again, as for each request of
+        a server, does not allocate after the first time.
+
+        @see datastore_pool
+    */
+    void reset() noexcept
+    {
+        polystore::reset();
+    }
+};
+
+//------------------------------------------------
+
+/** A pool of datastores cached for each thread
+
+    Creating a @ref datastore for each request allocates
+    its storage again each time. A pool keeps datastores
+    which were used before, with their storage, so that
+    a request can take one which is ready. Each thread
+    has its own cache, so taking and returning a datastore
+    does not synchronize with other threads. A returned
+    datastore is @ref datastore::reset, and is kept by
+    the cache of the thread which returns it if that
+    cache has room, or destroyed otherwise.
+
+    @par Example
+    @code
+    datastore_pool pool(&app);
+
+    // for each request, on any thread
+    auto ds = pool.acquire();
+    ds->emplace<request_info>();
+    invoke(*ds, [](request_info&, database& db){});
+    @endcode
+
+    @par Thread Safety
+    Distinct objects: Safe.@n
+    Shared objects: Safe, except for destruction.
+*/
+class datastore_pool
+{
+    struct cache
+    {
+        std::vector<datastore*> v;
+
+        BOOST_RTS_DECL
+        ~cache();
+
+        BOOST_RTS_DECL
+        explicit
+        cache(std::size_t max);
+    };
+
+public:
+    /** Returns a datastore to its pool
+    */
+    class deleter
+    {
+    public:
+        deleter() = default;
+
+        void operator()(datastore* ds) const noexcept
+        {
+            pool_->release(ds);
+        }
+
+    private:
+        friend class datastore_pool;
+
+        explicit
+        deleter(datastore_pool& pool) noexcept
+            : pool_(&pool)
+        {
+        }
+
+        datastore_pool* pool_ = nullptr;
+    };
+
+    /** An owning pointer to a datastore of the pool
+
+        Destroying or resetting the pointer returns
+        the datastore to the pool.
+    */
+    using pointer = std::unique_ptr<datastore, deleter>;
+
+    datastore_pool(datastore_pool const&) = delete;
+    datastore_pool& operator=(datastore_pool const&) = delete;
+
+    /** Destructor
+
+        The datastores cached for every thread are
+        destroyed. No datastore of the pool may be
+        in use.
+    */
+    ~datastore_pool() = default;
+
+    /** Constructor
+
+        @param parent The parent of each datastore, which
+            must outlive the pool, or `nullptr` for none.
+        @param max_per_thread The largest number of
+            datastores kept for one thread.
+        @param mr The memory resource of each datastore,
+            which must outlive the pool and be safe to use
+            from every thread using the pool, or `nullptr`
+            to use the global heap.
+    */
+    explicit
+    datastore_pool(
+        polystore const* parent = nullptr,
+        std::size_t max_per_thread = 4,
+        container::pmr::memory_resource* mr = nullptr)
+        : parent_(parent)
+        , mr_(mr)
+        , max_(max_per_thread)
+        , caches_(max_per_thread)
+    {
+    }
+
+    /** Return an empty datastore
+
+        A datastore cached for the calling thread is
+        returned if there is one, and a new one is made
+        otherwise.
+
+        @par Complexity
+        Constant.
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    BOOST_RTS_DECL
+    pointer
+    acquire();
+
+    /** Return the number of datastores cached for the calling thread
+    */
+    std::size_t
+    size() const noexcept
+    {
+        if(auto const c = caches_.find())
+            return c->v.size();
+        return 0;
+    }
+
+private:
+    BOOST_RTS_DECL
+    void
+    release(datastore* ds) noexcept;
+
+    polystore const* parent_;
+    container::pmr::memory_resource* mr_;
+    std::size_t max_;
+    per_thread<cache> caches_;
 };
 
 } // rts
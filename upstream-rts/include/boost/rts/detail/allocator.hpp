@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_ALLOCATOR_HPP
+#define BOOST_RTS_DETAIL_ALLOCATOR_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/except.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+using memory_resource = container::pmr::memory_resource;
+
+/*  Storage from a memory resource
+
+    A null resource means the global heap. This avoids
+    linking Boost.Container for its default resource,
+    and keeps the common case free of virtual calls.
+*/
+inline
+void*
+allocate(
+    memory_resource* mr,
+    std::size_t size,
+    std::size_t align)
+{
+    if(mr)
+        return mr->allocate(size, align);
+    return ::operator new(size);
+}
+
+inline
+void
+deallocate(
+    memory_resource* mr,
+    void* p,
+    std::size_t size,
+    std::size_t align) noexcept
+{
+    if(mr)
+        mr->deallocate(p, size, align);
+    else
+        ::operator delete(p);
+}
+
+// allocator for standard containers, which
+// travels with the contents on move and swap
+template<class T>
+class allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    allocator() = default;
+
+    explicit
+    allocator(
+        memory_resource* mr) noexcept
+        : mr_(mr)
+    {
+    }
+
+    template<class U>
+    allocator(
+        allocator<U> const& other) noexcept
+        : mr_(other.resource())
+    {
+    }
+
+    T*
+    allocate(std::size_t n)
+    {
+        if(n > std::size_t(-1) / sizeof(T))
+            detail::throw_bad_alloc();
+        return static_cast<T*>(detail::allocate(
+            mr_, n * sizeof(T), alignof(T)));
+    }
+
+    void
+    deallocate(T* p, std::size_t n) noexcept
+    {
+        detail::deallocate(mr_, p,
+            n * sizeof(T), alignof(T));
+    }
+
+    memory_resource*
+    resource() const noexcept
+    {
+        return mr_;
+    }
+
+    template<class U>
+    friend
+    bool
+    operator==(
+        allocator const& a,
+        allocator<U> const& b) noexcept
+    {
+        return a.mr_ == b.resource();
+    }
+
+    template<class U>
+    friend
+    bool
+    operator!=(
+        allocator const& a,
+        allocator<U> const& b) noexcept
+    {
+        return a.mr_ != b.resource();
+    }
+
+private:
+    memory_resource* mr_ = nullptr;
+};
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_ARENA_HPP
+#define BOOST_RTS_DETAIL_ARENA_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/allocator.hpp>
+#include <cstddef>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+/*  A chunked bump allocator
+
+    Storage is carved sequentially out of chunks which
+    grow geometrically, so objects allocated one after
+    another are adjacent in memory. Chunks are never
+    moved or released before the arena is cleared or
+    destroyed, which keeps every allocation stable.
+    Objects placed in the arena must be destroyed by
+    their owner; the arena only manages the memory.
+    Storage of objects removed individually is kept
+    in a free list and reused by later allocations.
+    Chunks come from the memory resource given on
+    construction, or the global heap if it is null.
+    A reset keeps the chunks as spares, which are used
+    again before any new chunk is obtained.
+*/
+class arena
+{
+public:
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    BOOST_RTS_DECL
+    ~arena();
+
+    arena() = default;
+
+    explicit
+    arena(memory_resource* mr) noexcept
+        : mr_(mr)
+    {
+    }
+
+    BOOST_RTS_DECL
+    arena(arena&& other) noexcept;
+
+    BOOST_RTS_DECL
+    void
+    swap(arena& other) noexcept;
+
+    memory_resource*
+    resource() const noexcept
+    {
+        return mr_;
+    }
+
+    /** Return suitably aligned storage
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    BOOST_RTS_DECL
+    void*
+    allocate(
+        std::size_t size,
+        std::size_t align);
+
+    /** Ensure size bytes can be allocated from one chunk
+
+        Allocations which follow, up to `size` bytes in
+        total including alignment padding, are carved
+        out of the current chunk without another request
+        to the memory resource.
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    BOOST_RTS_DECL
+    void
+    reserve(std::size_t size);
+
+    /** Return storage to the arena
+
+        Only the most recent allocation is reclaimed,
+        which is enough to undo a failed construction.
+        Other storage is released by @ref clear.
+    */
+    void
+    deallocate(void* p) noexcept
+    {
+        if(p == last_)
+        {
+            pos_ = static_cast<char*>(p);
+            last_ = nullptr;
+        }
+    }
+
+    /** Return storage of a known size to the arena for reuse
+
+        The storage is handed out again by @ref allocate
+        for a request which it can satisfy. Blocks too
+        small to be tracked are released by @ref clear.
+    */
+    BOOST_RTS_DECL
+    void
+    deallocate(
+        void* p,
+        std::size_t size) noexcept;
+
+    /** Return the number of bytes obtained for chunks
+
+        This includes the chunk headers, storage
+        which is free, and the unused end of each chunk.
+    */
+    BOOST_RTS_DECL
+    std::size_t
+    allocated() const noexcept;
+
+    /** Release all chunks
+    */
+    BOOST_RTS_DECL
+    void
+    clear() noexcept;
+
+    /** Discard all allocations, keeping the chunks
+
+        Later allocations are carved out of the kept
+        chunks first, so a sequence of allocations which
+        fit before fits again without using the memory
+        resource.
+    */
+    BOOST_RTS_DECL
+    void
+    reset() noexcept;
+
+    // RAII guard which deallocates unless released
+    class guard
+    {
+    public:
+        guard(
+            arena& a,
+            void* p,
+            std::size_t size) noexcept
+            : a_(a)
+            , p_(p)
+            , size_(size)
+        {
+        }
+
+        ~guard()
+        {
+            if(p_)
+                a_.deallocate(p_, size_);
+        }
+
+        void
+        release() noexcept
+        {
+            p_ = nullptr;
+        }
+
+    private:
+        arena& a_;
+        void* p_;
+        std::size_t size_;
+    };
+
+private:
+    struct chunk;
+    struct free_block;
+
+    char* from_spare(std::size_t size,
+        std::size_t align) noexcept;
+
+    memory_resource* mr_ = nullptr;
+    chunk* head_ = nullptr;
+    chunk* spare_ = nullptr;
+    free_block* free_ = nullptr;
+    char* pos_ = nullptr;
+    char* end_ = nullptr;
+    void* last_ = nullptr;
+    std::size_t next_ = 0;
+};
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_ATOMIC_SHARED_PTR_HPP
+#define BOOST_RTS_DETAIL_ATOMIC_SHARED_PTR_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+/*  A shared_ptr which is loaded and stored atomically
+
+    This uses the atomic free functions for shared_ptr
+    in every language mode, so the layout is a plain
+    shared_ptr whichever -std the library and the
+    program are built with. The functions are
+    deprecated in C++20 in favor of
+    std::atomic<std::shared_ptr<T>>, whose layout
+    differs, so the warning is suppressed here.
+*/
+#if defined(_MSC_VER) && ! defined(__clang__)
+# pragma warning( push )
+# pragma warning( disable : 4996 )
+#elif defined(__GNUC__)
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+template<class T>
+class atomic_shared_ptr
+{
+public:
+    explicit
+    atomic_shared_ptr(std::shared_ptr<T> p) noexcept
+        : p_(std::move(p))
+    {
+    }
+
+    std::shared_ptr<T>
+    load() const noexcept
+    {
+        return std::atomic_load_explicit(
+            &p_, std::memory_order_acquire);
+    }
+
+    void
+    store(std::shared_ptr<T> p) noexcept
+    {
+        std::atomic_store_explicit(&p_,
+            std::move(p), std::memory_order_release);
+    }
+
+private:
+    std::shared_ptr<T> p_;
+};
+
+#if defined(_MSC_VER) && ! defined(__clang__)
+# pragma warning( pop )
+#elif defined(__GNUC__)
+# pragma GCC diagnostic pop
+#endif
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_CPU_HPP
+#define BOOST_RTS_DETAIL_CPU_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <cstddef>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+// objects written by different threads are kept
+// this far apart to avoid false sharing
+constexpr std::size_t cache_line_size = 64;
+
+/** Return the number of processors, at least one
+*/
+BOOST_RTS_DECL
+std::size_t
+core_count() noexcept;
+
+/** Return the processor the calling thread runs on
+
+    The thread may be moved to another processor at
+    any time, so the result is only a hint. Platforms
+    which cannot report it return zero.
+*/
+BOOST_RTS_DECL
+std::size_t
+current_core() noexcept;
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -18,6 +18,9 @@ namespace boost {
 namespace rts {
 namespace detail {
 
+BOOST_RTS_DECL void BOOST_NORETURN throw_bad_alloc(
+    source_location const& loc = BOOST_CURRENT_LOCATION);
+
 BOOST_RTS_DECL void BOOST_NORETURN throw_bad_typeid(
     source_location const& loc = BOOST_CURRENT_LOCATION);
 
@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_FLAT_INDEX_HPP
+#define BOOST_RTS_DETAIL_FLAT_INDEX_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/allocator.hpp>
+#include <boost/core/typeinfo.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+// true if p points into the n bytes at first
+inline
+bool
+within(
+    void const* p,
+    void const* first,
+    std::size_t n) noexcept
+{
+    auto const u = reinterpret_cast<std::uintptr_t>(p);
+    auto const f = reinterpret_cast<std::uintptr_t>(first);
+    return u >= f && u - f < n;
+}
+
+/*  An open-addressing hash table from type to pointer
+
+    Entries are stored contiguously with their hash
+    precomputed, and collisions are resolved by linear
+    probing. Erasure uses backward-shift deletion so
+    no tombstones are left behind. The table never
+    holds more than half of its slots, which keeps
+    probe sequences short.
+*/
+class flat_index
+{
+public:
+    struct entry
+    {
+        std::size_t hash;
+        core::typeinfo const* ti;
+        // the type slot of ti
+        std::size_t slot;
+        // null for a key whose object is not made yet
+        void* p;
+        // set on the key of an object's own type, or
+        // on every key of an object not made yet
+        void const* owner;
+    };
+
+    flat_index(flat_index const&) = delete;
+    flat_index& operator=(flat_index const&) = delete;
+
+    BOOST_RTS_DECL
+    ~flat_index();
+
+    flat_index() = default;
+
+    explicit
+    flat_index(memory_resource* mr) noexcept
+        : mr_(mr)
+    {
+    }
+
+    BOOST_RTS_DECL
+    flat_index(flat_index&& other) noexcept;
+
+    BOOST_RTS_DECL
+    void
+    swap(flat_index& other) noexcept;
+
+    std::size_t
+    size() const noexcept
+    {
+        return n_;
+    }
+
+    std::size_t
+    capacity() const noexcept
+    {
+        return cap_;
+    }
+
+    // all slots, with empty ones having a null ti
+    entry const*
+    data() const noexcept
+    {
+        return v_;
+    }
+
+    entry const*
+    find_entry(
+        core::typeinfo const& ti,
+        std::size_t hash) const noexcept
+    {
+        if(n_ == 0)
+            return nullptr;
+        auto const mask = cap_ - 1;
+        for(auto i = hash & mask;; i = (i + 1) & mask)
+        {
+            auto const& e = v_[i];
+            if(! e.ti)
+                return nullptr;
+            if( e.hash == hash && (
+                    e.ti == &ti || *e.ti == ti))
+                return &e;
+        }
+    }
+
+    void*
+    find(
+        core::typeinfo const& ti,
+        std::size_t hash) const noexcept
+    {
+        auto const e = find_entry(ti, hash);
+        return e ? e->p : nullptr;
+    }
+
+    /** Insert a new entry
+
+        @return `false` if the key already exists.
+        @throws std::bad_alloc on allocation failure,
+            in which case the table is unchanged.
+    */
+    BOOST_RTS_DECL
+    bool
+    insert(
+        core::typeinfo const& ti,
+        std::size_t hash,
+        std::size_t slot,
+        void* p,
+        void const* owner = nullptr);
+
+    /** Ensure n entries fit without rehashing
+
+        @throws std::bad_alloc on allocation failure,
+            in which case the table is unchanged.
+    */
+    BOOST_RTS_DECL
+    void
+    reserve(std::size_t n);
+
+    BOOST_RTS_DECL
+    void
+    erase(
+        core::typeinfo const& ti,
+        std::size_t hash) noexcept;
+
+    // erase every entry pointing into the n bytes at first
+    BOOST_RTS_DECL
+    void
+    erase_within(
+        void const* first,
+        std::size_t n) noexcept;
+
+    // repoint entries from the n bytes at first to the same
+    // offsets in the n bytes at to
+    BOOST_RTS_DECL
+    void
+    relocate(
+        void const* first,
+        std::size_t n,
+        void* to) noexcept;
+
+    BOOST_RTS_DECL
+    void
+    clear() noexcept;
+
+    // erase every entry, keeping the table
+    BOOST_RTS_DECL
+    void
+    reset() noexcept;
+
+private:
+    void rehash(std::size_t cap);
+    void release() noexcept;
+
+    memory_resource* mr_ = nullptr;
+    entry* v_ = nullptr;
+    std::size_t n_ = 0;
+    std::size_t cap_ = 0;
+};
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_LOOKUP_STATS_HPP
+#define BOOST_RTS_DETAIL_LOOKUP_STATS_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/type_slot.hpp>
+#include <boost/core/typeinfo.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+// what a lookup was made by
+enum class lookup_kind
+{
+    find,
+    get,
+    invoke
+};
+
+// what a timing measures
+enum class timed_kind
+{
+    construct,
+    insert
+};
+
+// the counters of one key
+struct key_counters
+{
+    std::atomic<core::typeinfo const*> ti;
+    std::atomic<std::uint64_t> hits[3];
+    std::atomic<std::uint64_t> misses[3];
+    std::atomic<std::uint64_t> count[2];
+    std::atomic<std::uint64_t> ns[2];
+};
+
+/** Return a monotonic time in nanoseconds
+*/
+BOOST_RTS_DECL
+std::uint64_t
+now_ns() noexcept;
+
+/*  Counters of a container, indexed by type slot
+
+    Lookups are const and may run concurrently, so the
+    table grows without a lock. Chunk k holds the 2^k
+    slots starting at 2^k - 1, and is allocated on first
+    use with a compare-exchange. Chunks are freed only
+    with the table. Every update is a relaxed increment,
+    and a sample is dropped if its chunk can't be
+    allocated.
+*/
+class lookup_stats
+{
+public:
+    static constexpr std::size_t max_chunks =
+        sizeof(std::size_t) * 8;
+
+    lookup_stats(lookup_stats const&) = delete;
+    lookup_stats& operator=(lookup_stats const&) = delete;
+
+    BOOST_RTS_DECL
+    ~lookup_stats();
+
+    lookup_stats() noexcept
+    {
+        for(auto& c : c_)
+            c.store(nullptr, std::memory_order_relaxed);
+    }
+
+    // not thread-safe
+    BOOST_RTS_DECL
+    void
+    swap(lookup_stats& other) noexcept;
+
+    // zeroes every counter
+    BOOST_RTS_DECL
+    void
+    reset() noexcept;
+
+    void
+    count(
+        std::size_t slot,
+        core::typeinfo const& ti,
+        lookup_kind k,
+        bool hit) const noexcept
+    {
+        if(auto const c = at(slot, ti))
+            (hit ? c->hits : c->misses)[
+                static_cast<int>(k)].fetch_add(
+                    1, std::memory_order_relaxed);
+    }
+
+    void
+    time(
+        std::size_t slot,
+        core::typeinfo const& ti,
+        timed_kind k,
+        std::uint64_t ns) const noexcept
+    {
+        if(auto const c = at(slot, ti))
+        {
+            auto const i = static_cast<int>(k);
+            c->count[i].fetch_add(
+                1, std::memory_order_relaxed);
+            c->ns[i].fetch_add(
+                ns, std::memory_order_relaxed);
+        }
+    }
+
+    // the chunk holding slots [n - 1, 2n - 1), or null
+    key_counters const*
+    chunk(std::size_t k, std::size_t& n) const noexcept
+    {
+        n = std::size_t(1) << k;
+        return c_[k].load(std::memory_order_acquire);
+    }
+
+private:
+    key_counters*
+    at(
+        std::size_t slot,
+        core::typeinfo const& ti) const noexcept
+    {
+        // slot + 1 is in [2^k, 2^(k+1))
+        std::size_t k = 0;
+        for(auto i = slot + 1; i > 1; i >>= 1)
+            ++k;
+        auto c = c_[k].load(std::memory_order_acquire);
+        if(! c)
+        {
+            c = make(k);
+            if(! c)
+                return nullptr;
+        }
+        auto& e = c[slot + 1 - (std::size_t(1) << k)];
+        if(! e.ti.load(std::memory_order_relaxed))
+            e.ti.store(&ti, std::memory_order_release);
+        return &e;
+    }
+
+    BOOST_RTS_DECL
+    key_counters*
+    make(std::size_t k) const noexcept;
+
+    mutable std::atomic<key_counters*> c_[max_chunks];
+};
+
+/*  Times a construction or insertion
+
+    The time is recorded by stop, so an operation which
+    throws is not counted. Without the statistics macro
+    this is empty and every call does nothing.
+*/
+class stats_timer
+{
+public:
+#ifdef BOOST_RTS_POLYSTORE_STATS
+    stats_timer(
+        lookup_stats const& st,
+        timed_kind k) noexcept
+        : st_(&st)
+        , k_(k)
+        , t0_(now_ns())
+    {
+    }
+
+    void
+    stop(
+        std::size_t slot,
+        core::typeinfo const& ti) const noexcept
+    {
+        st_->time(slot, ti, k_, now_ns() - t0_);
+    }
+
+    template<class T>
+    void
+    stop() const noexcept
+    {
+        stop(type_slot<T>(), BOOST_CORE_TYPEID(T));
+    }
+
+private:
+    lookup_stats const* st_;
+    timed_kind k_;
+    std::uint64_t t0_;
+#else
+    explicit
+    stats_timer(timed_kind) noexcept
+    {
+    }
+
+    void
+    stop(
+        std::size_t,
+        core::typeinfo const&) const noexcept
+    {
+    }
+
+    template<class T>
+    void
+    stop() const noexcept
+    {
+    }
+#endif
+};
+
+} // detail
+} // rts
+} // boost
+
+#endif
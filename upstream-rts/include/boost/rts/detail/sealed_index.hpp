@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_SEALED_INDEX_HPP
+#define BOOST_RTS_DETAIL_SEALED_INDEX_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/flat_index.hpp>
+#include <cstdint>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+/*  An immutable perfect hash table from type to pointer
+
+    Built once from a flat_index using hash-and-displace:
+    keys are grouped into buckets, and each bucket gets a
+    displacement chosen so that every key lands in its own
+    slot. A lookup is then two multiplications, two loads
+    and one comparison, with no probing.
+*/
+class sealed_index
+{
+public:
+    using entry = flat_index::entry;
+
+    sealed_index(sealed_index const&) = delete;
+    sealed_index& operator=(sealed_index const&) = delete;
+
+    BOOST_RTS_DECL
+    ~sealed_index();
+
+    sealed_index() = default;
+
+    explicit
+    sealed_index(memory_resource* mr) noexcept
+        : mr_(mr)
+    {
+    }
+
+    BOOST_RTS_DECL
+    void
+    swap(sealed_index& other) noexcept;
+
+    entry const*
+    find_entry(
+        core::typeinfo const& ti,
+        std::size_t hash) const noexcept
+    {
+        if(! v_)
+            return nullptr;
+        auto const h = static_cast<std::uint64_t>(hash);
+        auto const d = disp_[bucket(h, rbits_)];
+        auto const& e = v_[slot(h, d, mbits_)];
+        if( e.ti && e.hash == hash && (
+                e.ti == &ti || *e.ti == ti))
+            return &e;
+        return nullptr;
+    }
+
+    void*
+    find(
+        core::typeinfo const& ti,
+        std::size_t hash) const noexcept
+    {
+        auto const e = find_entry(ti, hash);
+        return e ? e->p : nullptr;
+    }
+
+    bool
+    empty() const noexcept
+    {
+        return v_ == nullptr;
+    }
+
+    // bytes of the slot and displacement tables
+    std::size_t
+    allocated() const noexcept
+    {
+        return v_ ? bytes(mbits_, rbits_) : 0;
+    }
+
+    /** Replace the contents with the entries of an index
+
+        @return `false` if no perfect hash was found, which
+            can only happen when distinct keys have equal
+            hashes. The contents are unchanged.
+        @throws std::bad_alloc on allocation failure,
+            in which case the contents are unchanged.
+    */
+    BOOST_RTS_DECL
+    bool
+    build(flat_index const& src);
+
+    // as flat_index::relocate
+    BOOST_RTS_DECL
+    void
+    relocate(
+        void const* first,
+        std::size_t n,
+        void* to) noexcept;
+
+    BOOST_RTS_DECL
+    void
+    clear() noexcept;
+
+private:
+    // size of the slot and displacement tables
+    static
+    std::size_t
+    bytes(
+        unsigned mbits,
+        unsigned rbits) noexcept
+    {
+        return (std::size_t(1) << mbits) * sizeof(entry) +
+            (std::size_t(1) << rbits) * sizeof(std::uint32_t);
+    }
+
+    static
+    std::size_t
+    bucket(
+        std::uint64_t h,
+        unsigned bits) noexcept
+    {
+        return static_cast<std::size_t>(
+            (h * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+    }
+
+    static
+    std::size_t
+    slot(
+        std::uint64_t h,
+        std::uint32_t d,
+        unsigned bits) noexcept
+    {
+        return static_cast<std::size_t>(
+            ((h ^ d) * 0xD6E8FEB86659FD93ull) >> (64 - bits));
+    }
+
+    memory_resource* mr_ = nullptr;
+    entry* v_ = nullptr;
+    std::uint32_t* disp_ = nullptr;
+    unsigned mbits_ = 0;
+    unsigned rbits_ = 0;
+};
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,270 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_SLOT_TABLE_HPP
+#define BOOST_RTS_DETAIL_SLOT_TABLE_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/allocator.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+/*  A map from type slot to pointer
+
+    Slots are numbered across the whole process, so a
+    container holding a few objects may see large slot
+    numbers. Slots below a limit are kept in an array
+    indexed by slot, and the rest in a sorted array of
+    pairs. The limit is a multiple of the number of
+    entries, so the array stays proportional to the
+    contents of the container rather than to the number
+    of types used in the process. The limit never
+    shrinks, so a reservation holds for later inserts.
+*/
+template<class T>
+class slot_table
+{
+    // slots below this always go in the array
+    static constexpr std::size_t min_direct = 32;
+
+    using pair = std::pair<std::size_t, T>;
+
+public:
+    slot_table() = default;
+
+    explicit
+    slot_table(memory_resource* mr) noexcept
+        : v_(allocator<T>(mr))
+        , sp_(allocator<pair>(mr))
+    {
+    }
+
+    void
+    swap(slot_table& other) noexcept
+    {
+        v_.swap(other.v_);
+        sp_.swap(other.sp_);
+        std::swap(n_, other.n_);
+        std::swap(limit_, other.limit_);
+    }
+
+    T
+    find(std::size_t id) const noexcept
+    {
+        if(id < v_.size())
+            return v_[id];
+        if(sp_.empty())
+            return nullptr;
+        return find_sparse(id);
+    }
+
+    /** Ensure set can't fail for n keys with a slot member
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    template<class Key>
+    void
+    reserve(Key const* k, std::size_t n)
+    {
+        auto const limit = next_limit(n);
+        std::size_t direct = v_.size();
+        std::size_t sparse = 0;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            auto const id = k[i].slot;
+            if(id < v_.size())
+                continue;
+            if(id < limit)
+                direct = (std::max)(direct, id + 1);
+            else
+                ++sparse;
+        }
+        grow(limit, direct, sparse);
+    }
+
+    /** Ensure set can't fail for n slots up to max_slot
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    void
+    reserve(std::size_t max_slot, std::size_t n)
+    {
+        auto const limit = next_limit(n);
+        // without the slots themselves, a single
+        // allocation for the pairs covers every key
+        if(max_slot < limit)
+            grow(limit, (std::max)(
+                v_.size(), max_slot + 1), 0);
+        else
+            grow(limit, v_.size(), n);
+    }
+
+    // precondition: the slot was reserved
+    void
+    set(std::size_t id, T p) noexcept
+    {
+        if(id < v_.size())
+        {
+            if(! v_[id])
+                ++n_;
+            if(! p)
+                --n_;
+            v_[id] = p;
+            return;
+        }
+        auto const it = lower_bound(id);
+        if(it != sp_.end() && it->first == id)
+        {
+            if(p)
+            {
+                it->second = p;
+                return;
+            }
+            sp_.erase(it);
+            --n_;
+            return;
+        }
+        if(! p)
+            return;
+        // capacity was reserved
+        sp_.insert(it, pair(id, p));
+        ++n_;
+    }
+
+    // set each entry for which pred is true to null
+    template<class Pred>
+    void
+    erase_if(Pred pred) noexcept
+    {
+        for(auto& p : v_)
+            if(p && pred(p))
+            {
+                p = nullptr;
+                --n_;
+            }
+        auto const it = std::remove_if(
+            sp_.begin(), sp_.end(),
+            [&pred](pair const& e)
+            {
+                return pred(e.second);
+            });
+        n_ -= sp_.end() - it;
+        sp_.erase(it, sp_.end());
+    }
+
+    // replace each entry p with f(p), which is not null
+    template<class F>
+    void
+    update(F f) noexcept
+    {
+        for(auto& p : v_)
+            if(p)
+                p = f(p);
+        for(auto& e : sp_)
+            e.second = f(e.second);
+    }
+
+    // removes every entry, keeping the storage
+    void
+    reset() noexcept
+    {
+        std::fill(v_.begin(), v_.end(), nullptr);
+        sp_.clear();
+        n_ = 0;
+    }
+
+    void
+    clear() noexcept
+    {
+        v_.clear();
+        sp_.clear();
+        n_ = 0;
+        limit_ = 0;
+    }
+
+    std::size_t
+    allocated() const noexcept
+    {
+        return v_.capacity() * sizeof(T) +
+            sp_.capacity() * sizeof(pair);
+    }
+
+private:
+    std::size_t
+    next_limit(std::size_t n) noexcept
+    {
+        auto const m = 4 * (n_ + n);
+        if(limit_ < m)
+            limit_ = m;
+        if(limit_ < min_direct)
+            limit_ = min_direct;
+        return limit_;
+    }
+
+    void
+    grow(
+        std::size_t limit,
+        std::size_t direct,
+        std::size_t sparse)
+    {
+        if(direct > limit)
+            direct = limit;
+        if(sparse > 0)
+            sp_.reserve(sp_.size() + sparse);
+        if(direct <= v_.size())
+            return;
+        v_.resize(direct, nullptr);
+        // move the pairs which the array covers now
+        auto it = sp_.begin();
+        for(; it != sp_.end() && it->first < direct; ++it)
+            v_[it->first] = it->second;
+        sp_.erase(sp_.begin(), it);
+    }
+
+    typename std::vector<pair, allocator<pair>>::iterator
+    lower_bound(std::size_t id) noexcept
+    {
+        return std::lower_bound(sp_.begin(), sp_.end(), id,
+            [](pair const& e, std::size_t id_)
+            {
+                return e.first < id_;
+            });
+    }
+
+    T
+    find_sparse(std::size_t id) const noexcept
+    {
+        auto const it = std::lower_bound(
+            sp_.begin(), sp_.end(), id,
+            [](pair const& e, std::size_t id_)
+            {
+                return e.first < id_;
+            });
+        if(it != sp_.end() && it->first == id)
+            return it->second;
+        return nullptr;
+    }
+
+    std::vector<T, allocator<T>> v_;
+    std::vector<pair, allocator<pair>> sp_;
+    std::size_t n_ = 0; // non-null entries
+    std::size_t limit_ = 0;
+};
+
+} // detail
+} // rts
+} // boost
+
+#endif
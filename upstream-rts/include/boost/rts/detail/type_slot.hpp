@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_DETAIL_TYPE_SLOT_HPP
+#define BOOST_RTS_DETAIL_TYPE_SLOT_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/core/typeinfo.hpp>
+#include <cstddef>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+/** Return the process-wide slot number for a type
+
+    Slots are small integers handed out in order of
+    first use, starting from zero. The same type
+    always receives the same slot, even when the
+    caching statics are duplicated across shared
+    libraries, because the numbering is kept in a
+    single registry keyed by type.
+*/
+BOOST_RTS_DECL
+std::size_t
+make_type_slot(core::typeinfo const& ti);
+
+template<class T>
+std::size_t
+type_slot()
+{
+    static std::size_t const id =
+        make_type_slot(BOOST_CORE_TYPEID(T));
+    return id;
+}
+
+} // detail
+} // rts
+} // boost
+
+#endif
@@ -10,7 +10,9 @@
 #ifndef BOOST_RTS_DETAIL_TYPE_TRAITS_HPP
 #define BOOST_RTS_DETAIL_TYPE_TRAITS_HPP
 
+#include <cstddef>
 #include <type_traits>
+#include <utility>
 
 namespace boost {
 namespace rts {
@@ -26,6 +28,52 @@ using derived_from = std::integral_constant<bool,
         Derived const volatile*,
         Base const volatile*>::value>;
 
+template<std::size_t... Is> struct index_sequence {};
+
+template<std::size_t N, std::size_t... Is>
+struct make_index_sequence_impl
+    : make_index_sequence_impl<N - 1, N - 1, Is...>
+{
+};
+
+template<std::size_t... Is>
+struct make_index_sequence_impl<0, Is...>
+{
+    using type = index_sequence<Is...>;
+};
+
+template<std::size_t N>
+using make_index_sequence =
+    typename make_index_sequence_impl<N>::type;
+
+// true if T has a member `void start()`
+template<class T, class = void>
+struct has_start : std::false_type {};
+
+template<class T>
+struct has_start<T, typename std::enable_if<
+    std::is_same<decltype(std::declval<T>().start()),
+        void>::value>::type> : std::true_type {};
+
+// true if T has a member `void stop()`
+template<class T, class = void>
+struct has_stop : std::false_type {};
+
+template<class T>
+struct has_stop<T, typename std::enable_if<
+    std::is_same<decltype(std::declval<T>().stop()),
+        void>::value>::type> : std::true_type {};
+
+// true if T has a member `memory_usage()` returning a size
+template<class T, class = void>
+struct has_memory_usage : std::false_type {};
+
+template<class T>
+struct has_memory_usage<T, typename std::enable_if<
+    std::is_convertible<decltype(std::declval<T const&>(
+        ).memory_usage()), std::size_t>::value>::type>
+    : std::true_type {};
+
 template<bool...> struct bool_pack {};
 template<bool... Bs>
 struct all_true : std::is_same<bool_pack<
@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_ERROR_HPP
+#define BOOST_RTS_ERROR_HPP
+
+namespace boost {
+namespace rts {
+
+/** Error codes returned by the non-throwing container functions
+
+    These are reported by functions such as
+    @ref polystore::try_get and @ref try_invoke in
+    place of the exceptions thrown by their
+    counterparts.
+*/
+enum class error
+{
+    /// No object is stored for the key
+    not_found = 1,
+
+    /// A key is already used by another object
+    duplicate_key,
+
+    /// The container is sealed
+    sealed
+};
+
+} // rts
+} // boost
+
+#include <boost/rts/impl/error.hpp>
+
+#endif
@@ -0,0 +1,344 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_PER_CORE_HPP
+#define BOOST_RTS_PER_CORE_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/allocator.hpp>
+#include <boost/rts/detail/cpu.hpp>
+#include <boost/rts/detail/except.hpp>
+#include <boost/rts/detail/type_traits.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace rts {
+
+/** A set of replicas of an object, one for each processor
+
+    Objects which many threads update, such as counters,
+    caches and free lists, become a point of contention
+    when every thread uses the same instance. This holds
+    one instance of `T` for each processor, each starting
+    on its own cache line, and @ref local returns the one
+    for the processor the calling thread runs on. The
+    replicas can be visited with @ref size and
+    `operator[]`, to combine their state.
+
+    A thread can be moved to another processor at any
+    time, even between calling @ref local and using its
+    result, so two threads may use the same replica at
+    once. Replicas must therefore still be safe to use
+    concurrently, for example by using atomic members;
+    the gain is that they are rarely shared.
+
+    When `T` has a member `void start()` or `void stop()`,
+    this has the same members, which call them on every
+    replica. This allows a @ref polystore or @ref application
+    to start and stop the replicas.
+
+    @par Example
+    @code
+    struct hits
+    {
+        std::atomic<std::size_t> n{0};
+    };
+
+    polystore ps;
+    ps.emplace_per_core<hits>();
+
+    // on any thread
+    ps.get<per_core<hits>>().local().n.fetch_add(
+        1, std::memory_order_relaxed);
+
+    // aggregate
+    auto& h = ps.get<per_core<hits>>();
+    std::size_t total = 0;
+    for(std::size_t i = 0; i < h.size(); ++i)
+        total += h[i].n.load(std::memory_order_relaxed);
+    @endcode
+
+    @tparam T The type of each replica.
+
+    @see polystore::emplace_per_core
+*/
+template<class T>
+class per_core
+{
+    // padded so that replicas do not share a cache line
+    struct alignas(detail::cache_line_size) slot
+    {
+        T t;
+
+        template<class... Args>
+        explicit
+        slot(Args&... args)
+            : t(args...)
+        {
+        }
+    };
+
+public:
+    /** The type of each replica
+    */
+    using value_type = T;
+
+    per_core(per_core const&) = delete;
+    per_core& operator=(per_core const&) = delete;
+
+    /** Destructor
+
+        The replicas are destroyed in reverse order.
+    */
+    ~per_core()
+    {
+        while(n_ > 0)
+            p_[--n_].~slot();
+        detail::deallocate(mr_, raw_,
+            bytes(detail::core_count()),
+                alignof(std::max_align_t));
+    }
+
+    /** Constructor
+
+        One replica is constructed for each processor,
+        in order, each from the same arguments. The
+        arguments are passed as lvalues.
+
+        @par Exception Safety
+        Strong guarantee. If a construction throws, the
+        replicas already constructed are destroyed.
+
+        @throws std::bad_alloc on allocation failure.
+        @param mr The memory resource to allocate the
+            replicas with, or `nullptr` for the global heap.
+        @param args Arguments passed to the constructor
+            of each replica.
+    */
+    template<class... Args>
+    explicit
+    per_core(
+        container::pmr::memory_resource* mr,
+        Args&&... args)
+        : mr_(mr)
+    {
+        struct do_construct
+        {
+            per_core& self;
+            void* raw;
+            std::size_t n;
+
+            ~do_construct()
+            {
+                if(! raw)
+                    return;
+                while(self.n_ > 0)
+                    self.p_[--self.n_].~slot();
+                detail::deallocate(self.mr_, raw,
+                    n, alignof(std::max_align_t));
+            }
+
+            void apply(Args&... args)
+            {
+                auto const count = detail::core_count();
+                self.raw_ = raw;
+                self.p_ = align(raw);
+                while(self.n_ < count)
+                {
+                    ::new(&self.p_[self.n_]) slot(args...);
+                    ++self.n_;
+                }
+                raw = nullptr;
+            }
+        };
+
+        auto const n = bytes(detail::core_count());
+        do_construct{ *this, detail::allocate(
+            mr_, n, alignof(std::max_align_t)), n
+                }.apply(args...);
+    }
+
+    /** Return the number of replicas
+
+        This is the number of processors reported by
+        the platform, and at least one.
+    */
+    std::size_t
+    size() const noexcept
+    {
+        return n_;
+    }
+
+    /** Return the replica at index `i`
+
+        @par Preconditions
+        `i < size()`.
+    */
+    T&
+    operator[](std::size_t i) noexcept
+    {
+        return p_[i].t;
+    }
+
+    /** Return the replica at index `i`
+
+        @par Preconditions
+        `i < size()`.
+    */
+    T const&
+    operator[](std::size_t i) const noexcept
+    {
+        return p_[i].t;
+    }
+
+    /** Return the replica for the processor of the calling thread
+
+        @par Complexity
+        Constant. On Linux this reads the processor number
+        without a system call.
+    */
+    T&
+    local() noexcept
+    {
+        return p_[detail::current_core() % n_].t;
+    }
+
+    /** Return the replica for the processor of the calling thread
+
+        @par Complexity
+        Constant. On Linux this reads the processor number
+        without a system call.
+    */
+    T const&
+    local() const noexcept
+    {
+        return p_[detail::current_core() % n_].t;
+    }
+
+    /** Return the memory owned by the replicas
+
+        This is the storage of the replicas, including
+        the padding which keeps them on separate cache
+        lines. When `T` has a member `memory_usage()`,
+        the memory reported by each replica is added.
+
+        @see polystore::get_memory_report
+    */
+    std::size_t
+    memory_usage() const
+    {
+        auto n = bytes(detail::core_count());
+        for(std::size_t i = 0; i < n_; ++i)
+            n += owned(p_[i].t,
+                detail::has_memory_usage<T>{});
+        return n;
+    }
+
+    /** Invoke `start` on each replica, in order
+
+        If a replica throws, the replicas already started
+        are stopped in reverse order and the exception is
+        propagated.
+    */
+    template<class U = T>
+    auto
+    start() -> decltype(std::declval<U&>().start())
+    {
+        struct do_start
+        {
+            per_core& self;
+            std::size_t i = 0;
+
+            explicit
+            do_start(per_core& self_) noexcept
+                : self(self_)
+            {
+            }
+
+            ~do_start()
+            {
+                if(i == self.n_)
+                    return;
+                while(i-- > 0)
+                    undo(self.p_[i].t,
+                        detail::has_stop<T>{});
+            }
+
+            static void undo(T& t, std::true_type) { t.stop(); }
+            static void undo(T&, std::false_type) {}
+
+            void apply()
+            {
+                for(;i < self.n_;++i)
+                    self.p_[i].t.start();
+            }
+        };
+
+        do_start(*this).apply();
+    }
+
+    /** Invoke `stop` on each replica, in reverse order
+    */
+    template<class U = T>
+    auto
+    stop() -> decltype(std::declval<U&>().stop())
+    {
+        for(auto i = n_; i-- > 0;)
+            p_[i].t.stop();
+    }
+
+private:
+    // room for the replicas, and for aligning them
+    static
+    std::size_t
+    bytes(std::size_t n)
+    {
+        if(n > (std::size_t(-1) - alignof(slot)) / sizeof(slot))
+            detail::throw_bad_alloc();
+        return n * sizeof(slot) + alignof(slot) - 1;
+    }
+
+    static
+    std::size_t
+    owned(T const& t, std::true_type)
+    {
+        return t.memory_usage();
+    }
+
+    static
+    std::size_t
+    owned(T const&, std::false_type) noexcept
+    {
+        return 0;
+    }
+
+    static
+    slot*
+    align(void* p) noexcept
+    {
+        auto const u = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<slot*>(
+            (u + alignof(slot) - 1) &
+                ~std::uintptr_t(alignof(slot) - 1));
+    }
+
+    container::pmr::memory_resource* mr_;
+    void* raw_ = nullptr;
+    slot* p_ = nullptr;
+    std::size_t n_ = 0;
+};
+
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_PER_THREAD_HPP
+#define BOOST_RTS_PER_THREAD_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/type_traits.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace rts {
+
+namespace detail {
+
+struct per_thread_node;
+
+// the instance of one per_thread for one thread
+struct per_thread_slot
+{
+    std::uint64_t serial;
+    void* p;
+    per_thread_node* n;
+};
+
+// the instances of the calling thread, by id
+struct per_thread_table
+{
+    per_thread_slot* v;
+    std::size_t n;
+};
+
+/** Return the table of the calling thread
+
+    Entries are added on first use of each container
+    on the thread, and the instances are destroyed
+    when the thread exits.
+*/
+BOOST_RTS_DECL
+per_thread_table const&
+local_table() noexcept;
+
+// creates and destroys the instances of one container
+struct per_thread_ops
+{
+    void* (*make)(void const* args);
+    void (*destroy)(void* p) noexcept;
+    void (*free)(void* args) noexcept;
+};
+
+/*  The part of per_thread which does not depend on T
+
+    Each container has an id, which indexes the table
+    of every thread, and a serial number, which is never
+    reused. An id is reused only after its container is
+    destroyed, so a table entry whose serial number does
+    not match is left over from an earlier container.
+*/
+class per_thread_base
+{
+public:
+    per_thread_base(per_thread_base const&) = delete;
+    per_thread_base& operator=(per_thread_base const&) = delete;
+
+protected:
+    BOOST_RTS_DECL
+    ~per_thread_base();
+
+    // takes ownership of args
+    BOOST_RTS_DECL
+    per_thread_base(
+        void* args,
+        per_thread_ops const& ops);
+
+    void*
+    find_local() const noexcept
+    {
+        auto const& t = local_table();
+        if( id_ < t.n &&
+            t.v[id_].serial == serial_)
+            return t.v[id_].p;
+        return nullptr;
+    }
+
+    BOOST_RTS_DECL
+    void*
+    make_local();
+
+    BOOST_RTS_DECL
+    std::size_t
+    count() const noexcept;
+
+private:
+    friend struct per_thread_node;
+
+    void* args_;
+    per_thread_ops const* ops_;
+    std::size_t id_;
+    std::uint64_t serial_;
+    per_thread_node* head_ = nullptr;
+};
+
+} // detail
+
+/** An instance of an object for each thread which uses it
+
+    Objects which are not thread-safe, such as a reusable
+    compression stream or a scratch buffer, can be given
+    to many threads by keeping one instance per thread.
+    The first call to @ref local on a thread constructs
+    that thread's instance from the arguments given on
+    construction, and later calls return it. When the
+    thread exits, its instance is stopped, by calling
+    its member `void stop()` if it has one, and then
+    destroyed. Instances of threads which are still
+    running are stopped and destroyed with this object,
+    which must not happen while they are in use.
+
+    Instances are allocated from the global heap, since
+    they are made on arbitrary threads.
+
+    @par Example
+    @code
+    struct scratch
+    {
+        std::vector<char> buf;
+    };
+
+    per_thread<scratch> s;
+
+    // on any thread
+    auto& buf = s.local().buf;
+    @endcode
+
+    @par Thread Safety
+    Distinct objects: Safe.@n
+    Shared objects: Safe, except for destruction.
+
+    @tparam T The type of each instance.
+
+    @see polystore::emplace_thread_local
+*/
+template<class T>
+class per_thread
+    : private detail::per_thread_base
+{
+    template<class Args>
+    struct ops_for;
+
+public:
+    /** The type of each instance
+    */
+    using value_type = T;
+
+    /** Destructor
+
+        The instances of threads which have not exited
+        are stopped and destroyed.
+    */
+    ~per_thread() = default;
+
+    /** Constructor
+
+        Copies of the arguments are kept, and each
+        instance is constructed from them as lvalues.
+        Use `std::ref` to pass an argument by reference.
+
+        @throws std::bad_alloc on allocation failure.
+        @param args The arguments for each instance.
+    */
+    template<class... Args>
+    explicit
+    per_thread(Args&&... args)
+        : per_thread_base(
+            new std::tuple<typename std::decay<
+                Args>::type...>(std::forward<Args>(args)...),
+            ops_for<std::tuple<typename std::decay<
+                Args>::type...>>::value)
+    {
+    }
+
+    /** Return the instance of the calling thread
+
+        The instance is constructed on the first call
+        from each thread.
+
+        @par Complexity
+        Constant. After the first call, this costs one
+        access to a thread-local table.
+
+        @throws Any exception thrown by the constructor
+            of `T`, or `std::bad_alloc`, on the first call
+            from a thread.
+    */
+    T&
+    local()
+    {
+        if(auto const p = find_local())
+            return *static_cast<T*>(p);
+        return *static_cast<T*>(make_local());
+    }
+
+    /** Return the instance of the calling thread, or `nullptr`
+
+        Unlike @ref local, this does not construct
+        an instance when the thread has none.
+    */
+    T*
+    find() const noexcept
+    {
+        return static_cast<T*>(find_local());
+    }
+
+    /** Return the number of threads which have an instance
+    */
+    std::size_t
+    size() const noexcept
+    {
+        return count();
+    }
+};
+
+template<class T>
+template<class... Args>
+struct per_thread<T>::ops_for<std::tuple<Args...>>
+{
+    using tuple = std::tuple<Args...>;
+
+    static void* make(void const* args)
+    {
+        return make_impl(*static_cast<tuple const*>(args),
+            detail::make_index_sequence<sizeof...(Args)>{});
+    }
+
+    template<std::size_t... Is>
+    static void* make_impl(tuple const& t,
+        detail::index_sequence<Is...>)
+    {
+        return new T(std::get<Is>(t)...);
+    }
+
+    static void destroy(void* p) noexcept
+    {
+        do_stop(*static_cast<T*>(p),
+            detail::has_stop<T>{});
+        delete static_cast<T*>(p);
+    }
+
+    static void free(void* args) noexcept
+    {
+        delete static_cast<tuple*>(args);
+    }
+
+    static void do_stop(T& t, std::true_type) { t.stop(); }
+    static void do_stop(T&, std::false_type) {}
+
+    static detail::per_thread_ops const value;
+};
+
+template<class T>
+template<class... Args>
+detail::per_thread_ops const
+per_thread<T>::ops_for<std::tuple<Args...>>::value = {
+    &make, &destroy, &free };
+
+} // rts
+} // boost
+
+#endif
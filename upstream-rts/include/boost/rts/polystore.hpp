@@ -11,15 +11,33 @@
 #define BOOST_RTS_POLYSTORE_HPP
 
 #include <boost/rts/detail/config.hpp>
+#include <boost/rts/error.hpp>
+#include <boost/rts/detail/allocator.hpp>
+#include <boost/rts/detail/arena.hpp>
 #include <boost/rts/detail/call_traits.hpp>
 #include <boost/rts/detail/except.hpp>
+#include <boost/rts/detail/flat_index.hpp>
+#include <boost/rts/detail/lookup_stats.hpp>
+#include <boost/rts/detail/sealed_index.hpp>
+#include <boost/rts/detail/slot_table.hpp>
+#include <boost/rts/detail/type_slot.hpp>
 #include <boost/rts/detail/type_traits.hpp>
+#include <boost/rts/per_core.hpp>
+#include <boost/rts/per_thread.hpp>
+#include <boost/assert.hpp>
 #include <boost/core/typeinfo.hpp>
 #include <boost/core/detail/static_assert.hpp>
-#include <cstring>
+#include <boost/core/span.hpp>
+#include <boost/system/result.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
 #include <type_traits>
-#include <unordered_map>
 #include <vector>
 
 #if ! defined( BOOST_NO_TYPEID )
@@ -33,17 +51,32 @@ namespace detail {
 
 #if defined( BOOST_NO_TYPEID )
 
+#if ( defined(_WIN32) || defined(__CYGWIN__) ) && \
+    ( defined(__GNUC__) || defined(__clang__) ) && \
+    ! defined(BOOST_DISABLE_CURRENT_FUNCTION)
+// a type may have one typeinfo per module,
+// which compare equal by name
+# define BOOST_RTS_TYPEINFO_BY_NAME
+#endif
+
+/*  Without RTTI, Boost.Core provides one static typeinfo
+    object per type, and two of them are equal only when
+    they are the same object. The address is then the
+    identity of the type, and hashing and comparison are
+    constant time. Where typeinfo objects are compared
+    by name instead, the name is hashed.
+*/
 struct typeindex
 {
     typeindex(
         core::typeinfo const& ti) noexcept
-        : n_(std::strlen(ti.name()))
-        , ti_(&ti)
+        : ti_(&ti)
     { 
     }
 
     std::size_t hash_code() const noexcept
     {
+#ifdef BOOST_RTS_TYPEINFO_BY_NAME
         constexpr std::size_t offset_basis =
             (sizeof(std::size_t) == 8)
                 ? 1469598103934665603ull
@@ -52,49 +85,45 @@ struct typeindex
             (sizeof(std::size_t) == 8)
                 ? 1099511628211ull
                 : 16777619u;
-        auto const s = ti_->name();
         std::size_t h = offset_basis;
-        for(std::size_t i = 0; i < n_; ++i)
-            h = (h ^ static_cast<unsigned char>(s[i])) * prime;
+        for(auto s = ti_->name(); *s; ++s)
+            h = (h ^ static_cast<unsigned char>(*s)) * prime;
         return h;
+#else
+        // the low bits of an address are mostly zero,
+        // so fold the well-mixed high bits back down
+        auto const h = static_cast<std::uint64_t>(
+            reinterpret_cast<std::uintptr_t>(ti_)) *
+                0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+#endif
     }
 
     bool operator==(typeindex const& other) const noexcept
     {
-        return n_ == other.n_ && *ti_ == *other.ti_;
+        return ti_ == other.ti_ || *ti_ == *other.ti_;
     }
 
 private:
-    std::size_t n_;
     core::typeinfo const* ti_;
 };
 
-} // detail
-} // rts
-} // boost
-namespace std {
-template<>
-struct hash< boost::rts::detail::typeindex >
-{
-    std::size_t operator()(
-        boost::rts::detail::typeindex const& t) const noexcept
-    {
-        return t.hash_code();
-    }
-};
-} // std
-namespace boost {
-namespace rts {
-namespace detail {
-
 #else
 
 using typeindex = std::type_index;
 
 #endif
 
+class invoke_store;
+
 } // detail
 
+class concurrent_polystore;
+class snapshot_polystore;
+
+template<class... Ts>
+class static_polystore;
+
 /** A container of type-erased objects
 
     Objects are stored and retrieved by their type.
@@ -104,6 +133,28 @@ using typeindex = std::type_index;
     itself. In this case, a reference to the type
     must be convertible to a reference to the key type.
 
+    Once the set of stored objects is final, the container
+    may be sealed by calling @ref seal. Lookups in a sealed
+    container use a perfect hash index, and any attempt
+    to insert another object throws `std::logic_error`.
+
+    A container may be given a parent. Lookups which find
+    nothing in the container continue in the parent, and
+    then in its parent, while objects inserted into the
+    container shadow those of the same type in the parents.
+    Functions which return an existing object, such as
+    @ref try_emplace and @ref use, also consider objects
+    found in a parent. This allows cheap nested scopes, such as a store for
+    one request on top of the application-wide store.
+
+    When `BOOST_RTS_POLYSTORE_STATS` is defined, the
+    container counts the lookups of each key and times
+    the construction and insertion of each object; see
+    @ref stats. The macro changes the layout of the
+    class, so it must be defined the same way for the
+    library and for every program which uses it. Without
+    it, none of this is compiled.
+
     @par Example
     @code
     struct A
@@ -181,10 +232,87 @@ public:
     */
     polystore() = default;
 
+    /** Constructor
+
+        The container is initially empty. All of its internal
+        storage, including the stored objects themselves, is
+        obtained from the memory resource `mr`. Ownership of
+        the resource is not transferred; it must outlive the
+        container. Move construction and move assignment carry
+        the resource along with the contents.
+
+        @par Example
+        @code
+        char buf[4096];
+        container::pmr::monotonic_buffer_resource mr(buf, sizeof(buf));
+        polystore ps(&mr);
+        @endcode
+
+        @param mr The memory resource to use, or `nullptr`
+            to use the global heap.
+    */
+    BOOST_RTS_DECL
+    explicit
+    polystore(
+        container::pmr::memory_resource* mr) noexcept;
+
+    /** Constructor
+
+        The container is initially empty, and lookups which
+        find nothing in it continue in `parent`. Constructing
+        the container performs no allocation. Ownership of
+        the parent is not transferred; it must outlive the
+        container.
+
+        @param parent The container to fall back to, or
+            `nullptr` for none.
+        @param mr The memory resource to use, or `nullptr`
+            to use the global heap.
+    */
+    BOOST_RTS_DECL
+    explicit
+    polystore(
+        polystore const* parent,
+        container::pmr::memory_resource* mr = nullptr) noexcept;
+
+    /** Return the container which lookups fall back to
+
+        @return The parent, or `nullptr` if there is none.
+    */
+    polystore const*
+    parent() const noexcept
+    {
+        return parent_;
+    }
+
+    /** Return the memory resource used by the container
+
+        @return The memory resource, or `nullptr` if the
+            global heap is used.
+    */
+    container::pmr::memory_resource*
+    resource() const noexcept
+    {
+        return a_.resource();
+    }
+
     /** Return a pointer to the object associated with type `T`, or `nullptr`
 
-        If no object associated with `T` exists in the container,
-        `nullptr` is returned.
+        If no object associated with `T` exists in the container
+        or in any of its parents, `nullptr` is returned.
+
+        @par Complexity
+        Constant, plus one step per parent searched. Each type
+        is assigned a process-wide slot number on first use, and
+        the lookup is a bounds-checked array access with no
+        hashing. Slots much larger than the number of keys in
+        the container are kept in a sorted table instead, so
+        their lookup is logarithmic in its size.
+
+        An object registered with @ref register_factory is
+        returned only once it has been made. This function
+        never makes it; @ref get, @ref try_get and
+        @ref invoke do.
 
         @par Thread Safety
         `const` member function calls are thread-safe.
@@ -197,9 +325,30 @@ public:
     template<class T>
     T* find() const noexcept
     {
-        return static_cast<T*>(find(BOOST_CORE_TYPEID(T)));
+        return lookup<T>(detail::lookup_kind::find, false);
     }
 
+    /** Return a pointer to the object associated with a type, or `nullptr`
+
+        This overload is for callers which only have the
+        type information at runtime. The type is hashed and
+        looked up in an index of all keys, and then in
+        the indexes of the parents. As with the other
+        overload, an object which has a factory is returned
+        only once it has been made.
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+
+        @param ti The type information of the key to find.
+        @return A pointer to the associated object, or `nullptr` if none exists.
+    */
+    BOOST_RTS_DECL
+    void*
+    find(core::typeinfo const& ti) const noexcept;
+
     /** Return a reference to the object associated with type T
 
         If no such object exists in the container, an exception is thrown.
@@ -220,11 +369,178 @@ public:
     template<class T>
     T& get() const
     {
-        if(auto t = find<T>())
+        if(auto t = lookup<T>(detail::lookup_kind::get))
             return *t;
         detail::throw_bad_typeid();
     }
 
+    /** Return the object associated with type T, or an error
+
+        This is the same as @ref get, except that a missing
+        object is reported as an error instead of by
+        throwing an exception.
+
+        @par Example
+        @code
+        if(auto r = ps.try_get<metrics>())
+            r->record(elapsed);
+        @endcode
+
+        @par Thread Safety
+        Calls to `const` member functions are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+
+        @throws Any exception thrown by a factory registered
+            with @ref register_factory, on first use.
+        @tparam T The type of object to retrieve.
+        @return A reference to the associated object, or
+            @ref error::not_found.
+    */
+    template<class T>
+    system::result<T&>
+    try_get() const
+    {
+        if(auto t = lookup<T>(detail::lookup_kind::get))
+            return *t;
+        return BOOST_RTS_ERR(error::not_found);
+    }
+
+    /** Return pointers to the objects associated with several types
+
+        This is equivalent to calling @ref find for each type.
+        The lookups are independent of each other, so they
+        can overlap.
+
+        @par Example
+        @code
+        A* a;
+        B* b;
+        std::tie(a, b) = ps.find_all<A, B>();
+        @endcode
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+
+        @tparam Ts The types of objects to find.
+        @return A tuple holding, for each type, a pointer to the
+            associated object, or `nullptr` if none exists.
+    */
+    template<class... Ts>
+    std::tuple<Ts*...>
+    find_all() const noexcept
+    {
+        return std::tuple<Ts*...>(lookup<Ts>(
+            detail::lookup_kind::find, false)...);
+    }
+
+    /** Return references to the objects associated with several types
+
+        This is equivalent to calling @ref get for each type.
+        The lookups are independent of each other, so they
+        can overlap.
+
+        @par Example
+        @code
+        auto t = ps.get_all<A, B>();
+        A& a = std::get<0>(t);
+        @endcode
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+
+        @throws std::bad_typeid
+        If no object associated with one of the types is present.
+        @throws Any exception thrown by a factory registered
+            with @ref register_factory, on first use.
+        @tparam Ts The types of objects to retrieve.
+        @return A tuple of references to the associated objects.
+    */
+    template<class... Ts>
+    std::tuple<Ts&...>
+    get_all() const
+    {
+        return get_all_impl(std::tuple<Ts*...>(
+            lookup<Ts>(detail::lookup_kind::get)...),
+            detail::make_index_sequence<sizeof...(Ts)>{});
+    }
+
+    /** Return the objects bound to an interface with @ref emplace_multi
+
+        The pointers are contiguous and in the order of
+        registration, so that visiting every implementation
+        is a loop over an array. If this container has no
+        objects bound to `I`, those of its parent are
+        returned; otherwise the parent's are not included.
+        The span is invalidated by the next call
+        to @ref emplace_multi for `I`, and by @ref clear.
+
+        @par Example
+        @code
+        for(auto f : ps.get_all_of<filter>())
+            f->on_request(req);
+        @endcode
+
+        @par Complexity
+        Constant.
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+
+        @tparam I The interface type.
+        @return A span of pointers to the bound objects,
+            which is empty if there are none.
+    */
+    template<class I>
+    span<I* const>
+    get_all_of() const
+    {
+        auto const l = lookup<multi_list<I>>(
+            detail::lookup_kind::get);
+        if(! l)
+            return {};
+        return span<I* const>(l->v.data(), l->v.size());
+    }
+
+    /** Reserve space for objects and keys
+
+        After this call, objects may be inserted until the
+        container holds `objects` objects and `keys` keys in
+        total without growing the list of objects to destroy
+        or the index of keys. This avoids most reallocation
+        when many objects are inserted at once. The list of
+        objects with `start` or `stop` functions is not
+        reserved, since few objects have them, and neither is
+        the table of keys by type slot, whose size depends on
+        the slots of the types inserted. @ref emplace_all
+        reserves both.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::bad_alloc on allocation failure.
+        @param objects The total number of objects.
+        @param keys The total number of keys, counting the
+            type of each object and all of its additional keys.
+    */
+    BOOST_RTS_DECL
+    void
+    reserve(
+        std::size_t objects,
+        std::size_t keys);
+
     /** Construct and insert an anonymous object into the container
 
         A new object of type `T` is constructed in place using the provided
@@ -306,7 +622,7 @@ public:
             T&, typename get_key<T>::type&>::value);
         auto p = make_any<T>(std::forward<Args>(args)...);
         keyset<T, typename get_key<T>::type> ks(
-            *static_cast<T*>(p->get()));
+            *static_cast<T*>(p.get()));
         return *static_cast<T*>(insert_impl(
             std::move(p), ks.kn, ks.N));
     }
@@ -342,7 +658,7 @@ public:
         BOOST_CORE_STATIC_ASSERT(all_true<std::is_convertible<
             T&, Keys&>::value...>::value);
         auto p = make_any<T>(std::forward<Args>(args)...);
-        keyset<T, Keys...> ks(*static_cast<T*>(p->get()));
+        keyset<T, Keys...> ks(*static_cast<T*>(p.get()));
         return *static_cast<T*>(insert_impl(
             std::move(p), ks.kn, ks.N));
     }
@@ -378,11 +694,11 @@ public:
         // T& must be convertible to key_type&
         BOOST_CORE_STATIC_ASSERT(std::is_convertible<
             T&, typename get_key<T>::type&>::value);
-        if(auto t = find<T>())
+        if(auto t = lookup<T>(detail::lookup_kind::find))
             return *t;
         auto p = make_any<T>(std::forward<Args>(args)...);
         keyset<T, typename get_key<T>::type> ks(
-            *static_cast<T*>(p->get()));
+            *static_cast<T*>(p.get()));
         return *static_cast<T*>(insert_impl(
             std::move(p), ks.kn, ks.N));
     }
@@ -418,10 +734,10 @@ public:
         // T& must be convertible to each of Keys&
         BOOST_CORE_STATIC_ASSERT(all_true<std::is_convertible<
             T&, Keys&>::value...>::value);
-        if(auto t = find<T>())
+        if(auto t = lookup<T>(detail::lookup_kind::find))
             return *t;
         auto p = make_any<T>(std::forward<Args>(args)...);
-        keyset<T, Keys...> ks(*static_cast<T*>(p->get()));
+        keyset<T, Keys...> ks(*static_cast<T*>(p.get()));
         return *static_cast<T*>(insert_impl(
             std::move(p), ks.kn, ks.N));
     }
@@ -455,6 +771,69 @@ public:
                 std::forward<T>(t));
     }
 
+    /** Construct and insert an object, or return an error
+
+        This is the same as @ref emplace, except that a
+        duplicate key or a sealed container is reported as
+        an error instead of by throwing an exception. The
+        keys are checked before the object is constructed,
+        so nothing is constructed when an error is returned.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::bad_alloc on allocation failure.
+        @throws Any exception thrown by the constructor of `T`.
+        @tparam T The type of object to construct and insert.
+        @tparam Keys Optional key types associated with the object.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the inserted object, or
+            @ref error::duplicate_key or @ref error::sealed.
+    */
+    template<class T, class... Keys, class... Args>
+    system::result<T&>
+    try_emplace_new(Args&&... args)
+    {
+        if(sealed_)
+            return BOOST_RTS_ERR(error::sealed);
+        if(key_types<keyset_t<T, Keys...>>::any_of(*this))
+            return BOOST_RTS_ERR(error::duplicate_key);
+        return emplace<T, Keys...>(
+            std::forward<Args>(args)...);
+    }
+
+    /** Insert an object by moving or copying it, or return an error
+
+        This is the same as @ref insert, except that errors
+        are reported as by @ref try_emplace_new.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::bad_alloc on allocation failure.
+        @throws Any exception thrown by the constructor of `T`.
+        @tparam T The type of object to insert.
+        @tparam Keys Optional key types associated with the object.
+        @param t The object to insert.
+        @return A reference to the inserted object, or
+            @ref error::duplicate_key or @ref error::sealed.
+    */
+    template<class T, class... Keys>
+    system::result<typename std::remove_cv<
+        typename std::remove_reference<T>::type>::type&>
+    try_insert(T&& t)
+    {
+        return try_emplace_new<typename std::remove_cv<
+            typename std::remove_reference<T>::type>::type,
+                Keys...>(std::forward<T>(t));
+    }
+
     /** Return an existing object or create a new one
 
         If an object of the exact type `T` already exists in the container,
@@ -481,187 +860,1536 @@ public:
         // T must be default constructible
         BOOST_CORE_STATIC_ASSERT(
             std::is_default_constructible<T>::value);
-        if(auto t = find<T>())
+        if(auto t = lookup<T>(detail::lookup_kind::find))
             return *t;
         return emplace<T>();
     }
 
-protected:
-    struct any;
-    class elements;
+    /** Construct and insert several objects at once
 
-    /** Remove and destroy all objects in the container.
+        Each type in `Ts` is default-constructed and inserted
+        in order, as if by `emplace<T>()`. The tables and the
+        storage for all of the objects are sized once
+        beforehand, so large registrations do not reallocate
+        as they go. If a construction or insertion throws, the
+        objects already inserted by this call are destroyed.
 
-        All stored objects are destroyed in the reverse order
-        of construction. The container is left empty.
-    */
-    BOOST_RTS_DECL
-    void
-    clear() noexcept;
+        @par Example
+        @code
+        auto t = ps.emplace_all<A, B>();
+        A& a = std::get<0>(t);
+        @endcode
+
+        @par Exception Safety
+        Strong guarantee.
 
-    /** Return a range of all stored elements
         @par Thread Safety
-        `const` member function calls are thread-safe.
-        Calls to non-`const` member functions must not run concurrently
-        with other member functions on the same object.
-        @return An object representing the range of stored elements.
+        Not thread-safe.
+
+        @throws std::invalid_argument On duplicate insertion.
+        @throws std::logic_error if the container is sealed.
+        @tparam Ts The types of objects to construct and insert.
+        @return A tuple of references to the inserted objects.
     */
-    BOOST_RTS_DECL
-    elements
-    get_elements() noexcept;
+    template<class... Ts>
+    std::tuple<Ts&...>
+    emplace_all()
+    {
+        if(sealed_)
+            detail::throw_logic_error(
+                "polystore: sealed");
+        std::size_t const nk[] = { 0, keyset_t<Ts>::N... };
+        // elements of v_ and h_
+        std::size_t const nd[] = { 0, std::size_t(
+            ! std::is_trivially_destructible<Ts>::value)... };
+        std::size_t const nh[] = { 0, std::size_t(
+            detail::has_start<Ts>::value ||
+            detail::has_stop<Ts>::value)... };
+        std::size_t const ns[] = { 0, keyset_t<Ts>::max_slot()... };
+        // worst case padding for the alignment
+        std::size_t const nb[] = { 0,
+            (sizeof(Ts) + alignof(Ts) - 1)... };
+        std::size_t keys = 0;
+        std::size_t destroys = 0;
+        std::size_t hooks = 0;
+        std::size_t max_slot = 0;
+        std::size_t bytes = 0;
+        for(std::size_t i = 1; i <= sizeof...(Ts); ++i)
+        {
+            keys += nk[i];
+            destroys += nd[i];
+            hooks += nh[i];
+            max_slot = (std::max)(max_slot, ns[i]);
+            bytes += nb[i];
+        }
+        reserve_all(destroys, hooks, keys, max_slot, bytes);
+
+        core::typeinfo const* const ti[] = {
+            nullptr, &BOOST_CORE_TYPEID(Ts)... };
+        undo_emplace u(*this, ti + 1);
+        // braced lists are evaluated in order
+        std::tuple<Ts&...> t{ u.add(emplace<Ts>())... };
+        u.release();
+        return t;
+    }
 
-private:
-    template<bool...> struct bool_pack {};
-    template<bool... Bs>
-    struct all_true : std::is_same<bool_pack<
-        true, Bs...>, bool_pack<Bs..., true>> {};
+    /** Construct and insert one replica of an object for each processor
+
+        This inserts a @ref per_core holding one instance of
+        `T` for each processor, each on its own cache line and
+        each constructed from `args`. It is found under the
+        type `per_core<T>`, and @ref per_core::local returns
+        the instance for the calling thread's processor.
+        Replicas are allocated from the memory resource of
+        this container.
+
+        @par Example
+        @code
+        ps.emplace_per_core<counters>();
+        invoke(ps, [](per_core<counters>& c)
+            {
+                c.local().hit();
+            });
+        @endcode
 
-    template<class T, class = void>
-    struct has_start : std::false_type {};
+        @par Exception Safety
+        Strong guarantee.
 
-    template<class T>
-    struct has_start<T, typename std::enable_if<
-        std::is_same<decltype(std::declval<T>().start()),
-            void>::value>::type> : std::true_type {};
+        @par Thread Safety
+        Not thread-safe.
 
-    template<class T, class = void>
-    struct has_stop : std::false_type {};
+        @throws std::invalid_argument On duplicate insertion.
+        @throws std::logic_error if the container is sealed.
+        @tparam T The type of each replica.
+        @param args Arguments passed as lvalues to the
+            constructor of each replica.
+        @return A reference to the inserted replicas.
+    */
+    template<class T, class... Args>
+    per_core<T>&
+    emplace_per_core(Args&&... args)
+    {
+        return emplace<per_core<T>>(
+            resource(), std::forward<Args>(args)...);
+    }
 
-    template<class T>
-    struct has_stop<T, typename std::enable_if<
-        std::is_same<decltype(std::declval<T>().stop()),
-            void>::value>::type> : std::true_type {};
+    /** Register an object of which each thread has its own instance
+
+        This inserts a @ref per_thread holding copies of
+        `args`, found under the type `per_thread<T>`. The keys
+        of `T` are registered as @ref emplace would register
+        them, and finding any of them, through @ref find,
+        @ref get, or @ref invoke, returns the instance of the
+        calling thread, constructed on its first use. Each
+        instance is stopped and destroyed when its thread
+        exits, or with this container.
+
+        A @ref handle, or a callable returned by @ref bind,
+        keeps the instance of the thread which looked it up.
+        To pass instances between threads, pass the
+        `per_thread<T>` instead.
+
+        @par Example
+        @code
+        ps.emplace_thread_local<inflate_stream>();
+
+        // on any thread
+        invoke(ps, [](inflate_stream& s)
+            {
+                s.reset();
+            });
+        @endcode
 
-    struct key
-    {
-        detail::typeindex ti =
-            detail::typeindex(BOOST_CORE_TYPEID(void));
-        void* p = nullptr;
+        @par Exception Safety
+        Strong guarantee.
 
-        key() = default;
-        key(detail::typeindex const& ti_,
-            void* p_) noexcept : ti(ti_) , p(p_) {}
-    };
+        @par Thread Safety
+        Not thread-safe.
 
-    template<class T, class... Key>
-    struct keyset;
+        @throws std::invalid_argument On duplicate insertion.
+        @throws std::logic_error if the container is sealed.
+        @tparam T The type of each instance.
+        @tparam Keys Optional key types associated with
+            each instance.
+        @param args Arguments which are copied, and passed as
+            lvalues to the constructor of each instance.
+        @return A reference to the inserted container of
+            instances.
+    */
+    template<class T, class... Keys, class... Args>
+    per_thread<T>&
+    emplace_thread_local(Args&&... args);
 
-    template<class T>
-    struct keyset<T>
-    {
-        static constexpr std::size_t N = 1;
-        key kn[1];
+    /** Construct an object and bind it to one or more interfaces
 
-        explicit keyset(T& t) noexcept
-            : kn{ key(detail::typeindex(BOOST_CORE_TYPEID(T)), &t) }
-        {
-        }
-    };
+        Any number of objects may be bound to the same
+        interface, and @ref get_all_of returns all of them in
+        the order of registration. The object is inserted
+        anonymously, as if by @ref emplace_anon, so objects of
+        the same type may be bound more than once, and the
+        object is not found by @ref find or @ref get.
 
-    template<class T, class... Keys>
-    struct keyset
-    {
-        static constexpr std::size_t N = 1 + sizeof...(Keys);
-        key kn[N + 1];
+        The bindings of a container replace those of its
+        parent rather than extending them: once an object is
+        bound to `I` here, @ref get_all_of for `I` returns
+        only the objects bound in this container.
 
-        explicit keyset(T& t) noexcept
-            : kn{
-                key(detail::typeindex(BOOST_CORE_TYPEID(T)),
-                    std::addressof(t)),
-                key(detail::typeindex(BOOST_CORE_TYPEID(Keys)),
-                    &static_cast<Keys&>(t))..., }
-        {
-        }
-    };
+        @par Example
+        @code
+        ps.emplace_multi<gzip_filter, filter>();
+        ps.emplace_multi<auth_filter, filter>(keys);
+        @endcode
 
-    template<class T> struct any_impl;
+        @par Exception Safety
+        Strong guarantee.
 
-    using any_ptr = std::unique_ptr<any>;
+        @par Thread Safety
+        Not thread-safe.
 
-    template<class T, class... Args>
-    auto
-    make_any(Args&&... args) ->
-        std::unique_ptr<any_impl<T>>
+        @throws std::logic_error if the container is sealed.
+        @tparam T The type of object to construct and insert.
+        @tparam Interfaces The interfaces to bind the object to.
+            `T&` must be convertible to each of `Interfaces&`,
+            and no interface may appear more than once.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the inserted object.
+    */
+    template<class T, class... Interfaces, class... Args>
+    T&
+    emplace_multi(Args&&... args)
     {
-        return std::unique_ptr<any_impl<T>>(new
-            any_impl<T>(std::forward<Args>(args)...));
+        // At least one interface is needed
+        BOOST_CORE_STATIC_ASSERT(sizeof...(Interfaces) > 0);
+        // T& must be convertible to each of Interfaces&
+        BOOST_CORE_STATIC_ASSERT(all_true<std::is_convertible<
+            T&, Interfaces&>::value...>::value);
+        // Each interface may be named only once
+        BOOST_CORE_STATIC_ASSERT(distinct<Interfaces...>::value);
+        if(sealed_)
+            detail::throw_logic_error(
+                "polystore: sealed");
+        // make room first, so the binding can't fail,
+        // and erase the lists made here on failure
+        core::typeinfo const* made[sizeof...(Interfaces)];
+        std::size_t n = 0;
+        undo_emplace u(*this, made);
+        int const v0[] = { 0, (reserve_multi<Interfaces>(
+            u, made, n), 0)... };
+        (void)v0;
+        auto& t = emplace_anon<T>(std::forward<Args>(args)...);
+        u.release();
+        int const v1[] = { 0, (own_multi<Interfaces>()->v.push_back(
+            static_cast<Interfaces*>(&t)), 0)... };
+        (void)v1;
+        return t;
     }
 
-    void destroy() noexcept;
-    BOOST_RTS_DECL any& get(std::size_t i);
-    BOOST_RTS_DECL void* find(
-        core::typeinfo const& ti) const noexcept;
-    BOOST_RTS_DECL void* insert_impl(any_ptr,
-        key const* = nullptr, std::size_t = 0);
+    /** Register a factory which makes an object on first use
+
+        The keys of `T` are registered immediately, as @ref emplace
+        would register them, but no object is constructed. The
+        first lookup of any of these keys through @ref get,
+        @ref try_get, @ref invoke, @ref use or @ref try_emplace,
+        here or in a container whose parent this is, calls `f`
+        as if by @ref invoke and constructs `T` from the result.
+        Later lookups return the same object, and @ref find
+        returns it only once it is made. This defers the cost
+        of services which are rarely used.
+
+        Storage for the object is reserved here, so making it
+        allocates nothing and may happen in a `const` member
+        function. When several threads look up the object for
+        the first time, exactly one calls `f` and the others
+        wait for it. If `f` throws, the exception propagates
+        from the lookup and the next lookup calls `f` again.
+        `f` must not look up the object it makes.
+
+        An object made by a factory takes its place in the
+        order of construction when it is made, so it is
+        destroyed in reverse order with the other objects and
+        its `start` and `stop` functions are called as for
+        any other object. Room for its element is reserved
+        here. Such an object cannot be erased or replaced.
+
+        @par Example
+        @code
+        polystore ps;
+        ps.emplace<config>();
+        ps.register_factory<resolver>([](config const& cfg)
+            {
+                return resolver(cfg);
+            });
+        resolver& r = ps.get<resolver>(); // made here
+        @endcode
 
-    std::vector<any_ptr> v_;
-    std::unordered_map<
-        detail::typeindex, void*> m_;
-};
+        @par Exception Safety
+        Strong guarantee.
 
-//------------------------------------------------
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::invalid_argument On duplicate insertion.
+        @throws std::logic_error if the container is sealed.
+        @tparam T The type of object to make.
+        @tparam Keys Optional key types associated with the
+            object. These may not be given if `T` has a
+            nested `key_type`.
+        @param f The factory. Its arguments are injected as
+            by @ref invoke, and `T` must be constructible
+            from its result.
+    */
+    template<class T, class... Keys, class F>
+    void
+    register_factory(F&& f);
+
+    /** Remove and destroy the object of type `T`
+
+        The object whose own type is `T` is destroyed and
+        every key associated with it is removed, after which
+        lookups of those keys continue in the parent, if any.
+        The remaining objects are still destroyed in the
+        reverse order of construction, and the storage of the
+        erased object is reused by later insertions. The
+        object's `stop` function is not called.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::invalid_argument if `T` is only an
+            additional key of another object, or if the
+            object has a factory.
+        @throws std::logic_error if the container is sealed.
+        @tparam T The type of object to erase.
+        @return `true` if an object was erased, or `false` if
+            the container holds no object of type `T`.
+    */
+    template<class T>
+    bool
+    erase()
+    {
+        return erase_impl(BOOST_CORE_TYPEID(T));
+    }
+
+    /** Replace the object of type `T` with a new one
+
+        The object whose own type is `T` is destroyed and a
+        new one is constructed from `args`. Every key of the
+        old object refers to the new object afterwards, and
+        its place in the order of destruction is unchanged.
+        This is permitted in a sealed container, since the
+        set of keys stays the same. Neither `start` nor `stop`
+        is called.
+
+        The new object is always constructed before the old
+        one is destroyed, so the arguments may refer to the
+        old object or to anything it owns. If `T` is nothrow
+        move constructible, the new object is then moved into
+        the storage of the old one, and existing references
+        remain valid. Otherwise it stays in new storage, and
+        the old storage is reused by later insertions.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::bad_typeid if the container holds no
+            object of type `T`.
+        @throws std::invalid_argument if `T` is only an
+            additional key of another object, or if the
+            object has a factory.
+        @tparam T The type of object to replace.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the new object.
+    */
+    template<class T, class... Args>
+    T&
+    replace(Args&&... args)
+    {
+        auto const p = static_cast<T*>(
+            find_object(BOOST_CORE_TYPEID(T)));
+        return replace_impl<T>(p, std::integral_constant<bool,
+            std::is_nothrow_move_constructible<T>::value>{},
+                std::forward<Args>(args)...);
+    }
+
+    /** Freeze the set of stored objects
+
+        After this call, any function which would insert
+        an object throws `std::logic_error`. Functions
+        which only return an existing object, such as
+        @ref try_emplace or @ref use when the object is
+        present, are unaffected. The type-erased @ref find
+        switches to a perfect hash index, so that each
+        lookup is a single probe. Sealing a container
+        which is already sealed has no effect.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe. Once this function returns,
+        lookups may be performed concurrently from
+        any number of threads.
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    BOOST_RTS_DECL
+    void
+    seal();
+
+    /** Return `true` if @ref seal has been called
+    */
+    bool
+    is_sealed() const noexcept
+    {
+        return sealed_;
+    }
+
+    struct object_memory;
+    class memory_report;
+
+    /** Return the memory used by the container and its objects
+
+        The report lists each object owned by the container,
+        with its size and the memory it reports owning, and
+        totals the storage obtained by the container. An
+        object reports the memory it owns, such as internal
+        pools and buffers, by having a member function
+        `memory_usage() const` returning a number of bytes.
+        Objects without it report zero. Objects of the
+        parents, and objects whose keys refer to storage
+        owned elsewhere, are not included.
+
+        Since an @ref application is a container, this
+        gives the resident memory of each of its parts.
+
+        @par Example
+        @code
+        struct cache
+        {
+            std::vector<char> buf;
+
+            std::size_t memory_usage() const noexcept
+            {
+                return buf.capacity();
+            }
+        };
+
+        auto const r = app.get_memory_report();
+        log(r.total_bytes());
+        for(auto const& e : r)
+            log(e.type->name(), e.size + e.owned);
+        @endcode
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+        The `memory_usage` members are called on the calling
+        thread, and must be safe to call concurrently with
+        other uses of their objects.
+
+        @throws std::bad_alloc on allocation failure.
+        @return The report.
+    */
+    BOOST_RTS_DECL
+    memory_report
+    get_memory_report() const;
+
+    template<class T>
+    class handle;
+
+#ifdef BOOST_RTS_POLYSTORE_STATS
+    struct key_statistics;
+    class statistics;
+
+    /** Return the statistics of each key
+
+        A key is reported once it has been looked up in
+        this container, or an object with it as its own
+        type has been constructed or inserted here. A
+        lookup is counted by the container it is made
+        on, even when the object is found in a parent.
+        The counters are read one at a time while other
+        threads may be updating them, so the report is
+        not a consistent snapshot.
+
+        This function is only present when
+        `BOOST_RTS_POLYSTORE_STATS` is defined.
+
+        @par Example
+        @code
+        auto const st = ps.stats();
+        for(std::size_t i = 0; i < st.size(); ++i)
+            if(st[i].get_hits > 1000000)
+                std::cout << st[i].type->name() << "\n";
+        @endcode
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+
+        @throws std::bad_alloc on allocation failure.
+        @return The statistics, in order of the first use
+            of each key in the process.
+    */
+    BOOST_RTS_DECL
+    statistics
+    stats() const;
+
+    /** Set every counter of @ref stats to zero
+
+        This function is only present when
+        `BOOST_RTS_POLYSTORE_STATS` is defined.
+
+        @par Thread Safety
+        Not thread-safe.
+    */
+    BOOST_RTS_DECL
+    void
+    reset_stats() noexcept;
+#endif
+
+protected:
+    struct any;
+    class elements;
+
+    /** Remove and destroy all objects in the container.
+
+        All stored objects are destroyed in the reverse order
+        of construction. The container is left empty and
+        is no longer sealed.
+    */
+    BOOST_RTS_DECL
+    void
+    clear() noexcept;
+
+    /** Remove and destroy all objects, keeping the storage
+
+        This is the same as @ref clear, except that the
+        memory obtained for objects, indexes and lists is
+        kept for the objects inserted next. A container
+        which is filled the same way after each reset
+        then stops allocating. The index of a sealed
+        container is released.
+    */
+    BOOST_RTS_DECL
+    void
+    reset() noexcept;
+
+    /** Return a range of the stored elements which have a destructor
+
+        Objects which are trivially destructible are not
+        included. The elements are in the order of construction.
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+        @return An object representing the range of stored elements.
+    */
+    BOOST_RTS_DECL
+    elements
+    get_elements() noexcept;
+
+    /** Return a range of the stored elements which have `start` or `stop`
+
+        The elements are in the order of construction. Objects
+        without either function are not included, so visiting
+        the range costs nothing for them.
+
+        @par Thread Safety
+        `const` member function calls are thread-safe.
+        Calls to non-`const` member functions must not run concurrently
+        with other member functions on the same object.
+        @return An object representing the range of stored elements.
+    */
+    BOOST_RTS_DECL
+    elements
+    get_hooks() noexcept;
+
+private:
+    friend class concurrent_polystore;
+    friend class snapshot_polystore;
+    friend class detail::invoke_store;
+
+    template<class... Ts>
+    friend class static_polystore;
+
+    template<bool...> struct bool_pack {};
+    template<bool... Bs>
+    struct all_true : std::is_same<bool_pack<
+        true, Bs...>, bool_pack<Bs..., true>> {};
+
+    // true if no type appears twice in Ts
+    template<class... Ts>
+    struct distinct : std::true_type {};
+    template<class T, class... Ts>
+    struct distinct<T, Ts...> : std::integral_constant<bool,
+        all_true<! std::is_same<T, Ts>::value...>::value &&
+        distinct<Ts...>::value> {};
+
+    struct key
+    {
+        core::typeinfo const* ti =
+            &BOOST_CORE_TYPEID(void);
+        std::size_t slot = 0;
+        void* p = nullptr;
+
+        key() = default;
+        key(core::typeinfo const& ti_,
+            std::size_t slot_,
+            void* p_) noexcept
+            : ti(&ti_) , slot(slot_), p(p_) {}
+    };
+
+    template<class T, class... Key>
+    struct keyset;
+
+    // the keyset used when inserting T with Keys
+    template<bool HasKey, class T, class... Keys>
+    struct keyset_for
+    {
+        using type = keyset<T, Keys...>;
+    };
+
+    template<class T, class... Keys>
+    struct keyset_for<true, T, Keys...>
+    {
+        using type = keyset<T, typename get_key<T>::type>;
+    };
+
+    template<class T, class... Keys>
+    using keyset_t = typename keyset_for<
+        get_key<T>::value, T, Keys...>::type;
+
+    template<class T>
+    struct keyset<T>
+    {
+        static constexpr std::size_t N = 1;
+        key kn[1];
+
+        static std::size_t max_slot()
+        {
+            return detail::type_slot<T>();
+        }
+
+        explicit keyset(T& t)
+            : kn{ key(BOOST_CORE_TYPEID(T),
+                detail::type_slot<T>(), &t) }
+        {
+        }
+    };
+
+    template<class T, class... Keys>
+    struct keyset
+    {
+        static constexpr std::size_t N = 1 + sizeof...(Keys);
+        key kn[N + 1];
+
+        static std::size_t max_slot()
+        {
+            return (std::max)({ detail::type_slot<T>(),
+                detail::type_slot<Keys>()... });
+        }
+
+        explicit keyset(T& t)
+            : kn{
+                key(BOOST_CORE_TYPEID(T),
+                    detail::type_slot<T>(),
+                    std::addressof(t)),
+                key(BOOST_CORE_TYPEID(Keys),
+                    detail::type_slot<Keys>(),
+                    &static_cast<Keys&>(t))..., }
+        {
+        }
+    };
+
+    // what the container may need to do with an object
+    struct ops
+    {
+        void (*destroy)(void*);
+        void (*start)(void*);
+        void (*stop)(void*);
+        std::size_t size;
+        core::typeinfo const* type;
+        std::size_t (*memory_usage)(void const*);
+    };
+
+    template<class T> struct ops_for;
+    class any_ptr;
+
+    // an object made on first use
+    struct lazy;
+    struct lazy_key;
+
+    template<class T, class F, class... Keys>
+    struct lazy_impl;
+
+    template<class F, class KS>
+    struct lazy_for;
+
+    // the key types of a keyset
+    template<class KS>
+    struct key_types;
+
+    // the objects bound to interface I
+    template<class I>
+    struct multi_list
+    {
+        std::vector<I*, detail::allocator<I*>> v;
+
+        explicit
+        multi_list(
+            container::pmr::memory_resource* mr)
+            : v(detail::allocator<I*>(mr))
+        {
+        }
+
+        std::size_t
+        memory_usage() const noexcept
+        {
+            return v.capacity() * sizeof(I*);
+        }
+    };
+
+    // the list of this container, ignoring the parent
+    template<class I>
+    multi_list<I>*
+    own_multi() const noexcept
+    {
+        return static_cast<multi_list<I>*>(s_.find(
+            detail::type_slot<multi_list<I>>()));
+    }
+
+    template<class T, class... Keys>
+    struct local_impl;
+
+    template<class KS>
+    struct local_for;
+
+    // objects are placed contiguously in the
+    // arena, with no header and no vtable
+    template<class T, class... Args>
+    any_ptr
+    make_any(Args&&... args);
+
+    template<class T, class... Args>
+    any_ptr
+    construct(Args&&... args);
+
+    // args may refer into *p, so they are used up
+    // before the old object is destroyed
+    template<class T, class... Args>
+    T&
+    replace_impl(T* p, std::true_type, Args&&... args)
+    {
+        T t(std::forward<Args>(args)...);
+        p->~T();
+        return *::new(p) T(std::move(t));
+    }
+
+    template<class T, class... Args>
+    T&
+    replace_impl(T* p, std::false_type, Args&&... args)
+    {
+        auto np = construct<T>(std::forward<Args>(args)...);
+        auto const t = static_cast<T*>(np.get());
+        relocate(p, np.release());
+        return *t;
+    }
+
+    BOOST_RTS_DECL void* find_object(core::typeinfo const& ti) const;
+    BOOST_RTS_DECL bool has_any(core::typeinfo const* const* ti,
+        std::size_t n) const noexcept;
+    BOOST_RTS_DECL bool erase_impl(core::typeinfo const& ti);
+    BOOST_RTS_DECL void relocate(void* from, any to) noexcept;
+    BOOST_RTS_DECL void reserve_all(std::size_t destroys,
+        std::size_t hooks, std::size_t keys,
+        std::size_t max_slot, std::size_t bytes);
+    BOOST_RTS_DECL void register_impl(lazy& l,
+        lazy_key const* k, std::size_t n);
+    BOOST_RTS_DECL void* make(lazy& l) const;
+
+    // erases the objects of a partial emplace_all
+    class undo_emplace
+    {
+    public:
+        // the first n objects of ti are inserted already
+        undo_emplace(
+            polystore& ps,
+            core::typeinfo const* const* ti,
+            std::size_t n = 0) noexcept
+            : ps_(ps)
+            , ti_(ti)
+            , n_(n)
+        {
+        }
+
+        ~undo_emplace()
+        {
+            while(n_ > 0)
+                ps_.erase_impl(*ti_[--n_]);
+        }
+
+        template<class T>
+        T&
+        add(T& t) noexcept
+        {
+            ++n_;
+            return t;
+        }
+
+        void
+        release() noexcept
+        {
+            n_ = 0;
+        }
+
+    private:
+        polystore& ps_;
+        core::typeinfo const* const* ti_;
+        std::size_t n_;
+    };
+
+    // makes room in the list of I, recording a
+    // new list in made[n] so that u can erase it
+    template<class I>
+    void
+    reserve_multi(
+        undo_emplace& u,
+        core::typeinfo const** made,
+        std::size_t& n)
+    {
+        auto l = own_multi<I>();
+        if(! l)
+        {
+            l = &emplace<multi_list<I>>(resource());
+            made[n++] = &BOOST_CORE_TYPEID(multi_list<I>);
+            u.add(*l);
+        }
+        if(l->v.size() == l->v.capacity())
+            l->v.reserve(l->v.empty() ?
+                4 : 2 * l->v.size());
+    }
+
+    // search this container, then the parents
+    void* find_slot(std::size_t id) const;
+    // as find_slot, without making objects
+    void* find_made(std::size_t id) const noexcept;
+
+    // find, counting the lookup as k, and
+    // making the object if it has a factory
+    template<class T>
+    T* lookup(
+        detail::lookup_kind k,
+        bool make = true) const
+    {
+        auto const id = detail::type_slot<T>();
+        auto const p = static_cast<T*>(make ?
+            find_slot(id) : find_made(id));
+#ifdef BOOST_RTS_POLYSTORE_STATS
+        st_.count(id, BOOST_CORE_TYPEID(T), k, p != nullptr);
+#else
+        (void)k;
+#endif
+        return p;
+    }
+    void* resolve(lazy_key const& k) const;
+
+    detail::stats_timer
+    start_timer(detail::timed_kind k) const noexcept
+    {
+#ifdef BOOST_RTS_POLYSTORE_STATS
+        return detail::stats_timer(st_, k);
+#else
+        return detail::stats_timer(k);
+#endif
+    }
+
+    // changes when the keys of this
+    // container or of a parent change
+    std::size_t
+    generation() const noexcept
+    {
+        std::size_t n = 0;
+        for(auto ps = this; ps; ps = ps->parent_)
+            n += ps->gen_;
+        return n;
+    }
+
+    template<class... Ts, std::size_t... Is>
+    static
+    std::tuple<Ts&...>
+    get_all_impl(
+        std::tuple<Ts*...> const& t,
+        detail::index_sequence<Is...>)
+    {
+        bool const found[] = { true,
+            (std::get<Is>(t) != nullptr)... };
+        for(auto const b : found)
+            if(! b)
+                detail::throw_bad_typeid();
+        return std::tuple<Ts&...>(*std::get<Is>(t)...);
+    }
+
+    void destroy() noexcept;
+    BOOST_RTS_DECL void* insert_impl(any_ptr,
+        key const* = nullptr, std::size_t = 0);
+    BOOST_RTS_DECL void insert_keys(
+        key const* k, std::size_t n);
+    void add_keys(key const* k, std::size_t n,
+        void const* owner);
+
+    static std::size_t hash(
+        core::typeinfo const& ti) noexcept
+    {
+        return detail::typeindex(ti).hash_code();
+    }
+
+    using any_vector = std::vector<
+        any, detail::allocator<any>>;
+
+    detail::arena a_;
+    // in order of construction, only for objects
+    // which have a nontrivial destructor. Objects
+    // made by factories are appended when made.
+    mutable any_vector v_;
+    // in order of construction, only for objects
+    // which have `start` or `stop`
+    mutable any_vector h_;
+    detail::flat_index m_;
+    // objects by type slot
+    detail::slot_table<void*> s_;
+    // keys of objects not made yet, by type slot
+    detail::slot_table<lazy_key const*> ls_;
+    detail::sealed_index ph_;
+    lazy* lazy_ = nullptr; // most recently registered
+    // factory objects not made yet which need an
+    // element of v_ or h_, whose room is reserved
+    mutable std::size_t lazy_v_ = 0;
+    mutable std::size_t lazy_h_ = 0;
+    // serializes appending made objects
+    mutable std::mutex lm_;
+    polystore const* parent_ = nullptr;
+    std::size_t gen_ = 0; // changes when keys change
+    bool sealed_ = false;
+#ifdef BOOST_RTS_POLYSTORE_STATS
+    detail::lookup_stats st_;
+#endif
+};
+
+//------------------------------------------------
+
+/*  A stored object which needs more than its storage
+
+    Objects which are trivially destructible and have
+    neither `start` nor `stop` are not represented by
+    an element, so they cost nothing beyond their size.
+*/
+struct polystore::any
+{
+    void
+    start()
+    {
+        if(o_->start)
+            o_->start(p_);
+    }
+
+    void
+    stop()
+    {
+        if(o_->stop)
+            o_->stop(p_);
+    }
+
+private:
+    friend class polystore;
+
+    any(void* p, ops const& o) noexcept
+        : p_(p)
+        , o_(&o)
+    {
+    }
+
+    void* p_;
+    ops const* o_;
+};
+
+template<class T>
+struct polystore::ops_for
+{
+    static void destroy(void* p)
+    {
+        static_cast<T*>(p)->~T();
+    }
+
+    static void start(void* p)
+    {
+        do_start(*static_cast<T*>(p), detail::has_start<T>{});
+    }
+
+    static void stop(void* p)
+    {
+        do_stop(*static_cast<T*>(p), detail::has_stop<T>{});
+    }
+
+    static std::size_t memory_usage(void const* p)
+    {
+        return do_memory_usage(*static_cast<T const*>(p),
+            detail::has_memory_usage<T>{});
+    }
+
+    static void do_start(T& t, std::true_type) { t.start(); }
+    static void do_start(T&, std::false_type) {}
+    static void do_stop(T& t, std::true_type) { t.stop(); }
+    static void do_stop(T&, std::false_type) {}
+    static std::size_t do_memory_usage(
+        T const& t, std::true_type) { return t.memory_usage(); }
+    static std::size_t do_memory_usage(
+        T const&, std::false_type) { return 0; }
+
+    static ops const value;
+};
+
+template<class T>
+polystore::ops const
+polystore::ops_for<T>::value = {
+    std::is_trivially_destructible<T>::value ?
+        nullptr : &ops_for<T>::destroy,
+    detail::has_start<T>::value ? &ops_for<T>::start : nullptr,
+    detail::has_stop<T>::value ? &ops_for<T>::stop : nullptr,
+    sizeof(T),
+    &BOOST_CORE_TYPEID(T),
+    detail::has_memory_usage<T>::value ?
+        &ops_for<T>::memory_usage : nullptr };
+
+// owns a new object until it is inserted
+class polystore::any_ptr
+{
+public:
+    any_ptr(
+        detail::arena& a,
+        void* p,
+        ops const& o) noexcept
+        : a_(&a)
+        , e_(p, o)
+    {
+    }
+
+    any_ptr(any_ptr&& other) noexcept
+        : a_(other.a_)
+        , e_(other.e_)
+    {
+        other.e_.p_ = nullptr;
+    }
+
+    ~any_ptr()
+    {
+        if(! e_.p_)
+            return;
+        if(e_.o_->destroy)
+            e_.o_->destroy(e_.p_);
+        a_->deallocate(e_.p_, e_.o_->size);
+    }
+
+    void*
+    get() const noexcept
+    {
+        return e_.p_;
+    }
+
+    ops const*
+    get_ops() const noexcept
+    {
+        return e_.o_;
+    }
+
+    // true if the object belongs in v_
+    bool
+    has_destroy() const noexcept
+    {
+        return e_.o_->destroy != nullptr;
+    }
+
+    // true if the object belongs in h_
+    bool
+    has_hooks() const noexcept
+    {
+        return e_.o_->start || e_.o_->stop;
+    }
+
+    any
+    release() noexcept
+    {
+        auto const e = e_;
+        e_.p_ = nullptr;
+        return e;
+    }
+
+private:
+    detail::arena* a_;
+    any e_;
+};
+
+template<class T, class... Args>
+auto
+polystore::
+make_any(Args&&... args) ->
+    any_ptr
+{
+    if(sealed_)
+        detail::throw_logic_error(
+            "polystore: sealed");
+    return construct<T>(std::forward<Args>(args)...);
+}
+
+template<class T, class... Args>
+auto
+polystore::
+construct(Args&&... args) ->
+    any_ptr
+{
+    auto const pv = a_.allocate(
+        sizeof(T), alignof(T));
+    detail::arena::guard g(a_, pv, sizeof(T));
+    auto const t = start_timer(
+        detail::timed_kind::construct);
+    auto const p = ::new(pv) T(
+        std::forward<Args>(args)...);
+    t.stop<T>();
+    g.release();
+    return any_ptr(a_, p, ops_for<T>::value);
+}
+
+//------------------------------------------------
+
+/*  A factory registration
+
+    The object is constructed in storage reserved at
+    registration, while holding the mutex. Its pointer
+    is published with a release store once it is made,
+    so lookups after that take one acquire load and no
+    lock. A mutex is used rather than std::call_once,
+    which some implementations leave locked when the
+    function throws.
+*/
+struct polystore::lazy
+{
+    std::atomic<void*> p;
+    std::mutex m;
+    void* storage;
+    ops const* o;
+    void* (*make)(lazy&, polystore const&);
+    void (*destroy)(lazy&);
+    lazy* next = nullptr; // registered before this
+
+    lazy(
+        void* storage_,
+        ops const& o_,
+        void* (*make_)(lazy&, polystore const&),
+        void (*destroy_)(lazy&)) noexcept
+        : p(nullptr)
+        , storage(storage_)
+        , o(&o_)
+        , make(make_)
+        , destroy(destroy_)
+    {
+    }
+};
+
+// one of the keys of a factory registration
+struct polystore::lazy_key
+{
+    lazy* l;
+    // converts the made object to the key type
+    void* (*cast)(void*);
+    core::typeinfo const* ti;
+    std::size_t slot;
+};
+
+inline
+void*
+polystore::
+find_slot(std::size_t id) const
+{
+    for(auto ps = this; ps; ps = ps->parent_)
+    {
+        if(auto const p = ps->s_.find(id))
+            return p;
+        if(auto const k = ps->ls_.find(id))
+            return ps->resolve(*k);
+    }
+    return nullptr;
+}
+
+inline
+void*
+polystore::
+find_made(std::size_t id) const noexcept
+{
+    for(auto ps = this; ps; ps = ps->parent_)
+    {
+        if(auto const p = ps->s_.find(id))
+            return p;
+        if(auto const k = ps->ls_.find(id))
+        {
+            auto const p = k->l->p.load(
+                std::memory_order_acquire);
+            return p ? k->cast(p) : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+inline
+void*
+polystore::
+resolve(lazy_key const& k) const
+{
+    auto p = k.l->p.load(std::memory_order_acquire);
+    if(! p)
+        p = make(*k.l);
+    return k.cast(p);
+}
+
+//------------------------------------------------
+
+class polystore::elements
+{
+public:
+    std::size_t size() const noexcept
+    {
+        return n_;
+    }
+
+    any& operator[](
+        std::size_t i) noexcept
+    {
+        return v_[i];
+    }
+
+private:
+    friend class polystore;
+
+    elements(
+        std::size_t n,
+        any_vector& v)
+        : n_(n)
+        , v_(v)
+    {
+    }
+
+    std::size_t n_;
+    any_vector& v_;
+};
+
+//------------------------------------------------
+
+/** The memory used by one object
+
+    @see polystore::get_memory_report
+*/
+struct polystore::object_memory
+{
+    /// The type of the object
+    core::typeinfo const* type;
+
+    /// The size of the object, as by `sizeof`
+    std::size_t size;
+
+    /// The bytes reported by its `memory_usage`, or zero
+    std::size_t owned;
+};
+
+/** The memory used by a container
+
+    @see polystore::get_memory_report
+*/
+class polystore::memory_report
+{
+public:
+    /** Return the number of objects
+    */
+    std::size_t size() const noexcept
+    {
+        return v_.size();
+    }
+
+    /** Return an object, in no particular order
+    */
+    object_memory const& operator[](
+        std::size_t i) const noexcept
+    {
+        return v_[i];
+    }
+
+    object_memory const* begin() const noexcept
+    {
+        return v_.data();
+    }
+
+    object_memory const* end() const noexcept
+    {
+        return v_.data() + v_.size();
+    }
+
+    /** Return the sum of the sizes of the objects
+    */
+    std::size_t object_bytes() const noexcept
+    {
+        return objects_;
+    }
+
+    /** Return the sum of the memory the objects report owning
+    */
+    std::size_t owned_bytes() const noexcept
+    {
+        return owned_;
+    }
+
+    /** Return the bytes obtained to store the objects
+
+        This is at least @ref object_bytes.
+    */
+    std::size_t storage_bytes() const noexcept
+    {
+        return storage_;
+    }
+
+    /** Return the storage not used by the listed objects
+
+        This includes alignment padding, storage not
+        used yet or freed by erasure, the records of
+        factories, storage reserved for objects which
+        factories have not made yet, and the headers
+        of the allocations.
+    */
+    std::size_t overhead_bytes() const noexcept
+    {
+        return storage_ - objects_;
+    }
+
+    /** Return the bytes used by the indexes of the container
+
+        This includes the hash indexes, the slot tables
+        and the lists of objects to destroy, start and stop.
+    */
+    std::size_t index_bytes() const noexcept
+    {
+        return index_;
+    }
+
+    /** Return the total memory used
+    */
+    std::size_t total_bytes() const noexcept
+    {
+        return storage_ + index_ + owned_;
+    }
 
-struct BOOST_SYMBOL_VISIBLE
-    polystore::any
-{
-    BOOST_RTS_DECL virtual ~any();
-    virtual void start() = 0;
-    virtual void stop() = 0;
 private:
     friend class polystore;
-    virtual void* get() noexcept = 0;
+
+    memory_report() = default;
+
+    std::vector<object_memory> v_;
+    std::size_t objects_ = 0;
+    std::size_t owned_ = 0;
+    std::size_t storage_ = 0;
+    std::size_t index_ = 0;
 };
 
 //------------------------------------------------
 
-class polystore::elements
+#ifdef BOOST_RTS_POLYSTORE_STATS
+
+/** The statistics of one key
+
+    Lookups are counted separately for @ref polystore::find,
+    for @ref polystore::get and @ref polystore::try_get,
+    and for the arguments of @ref invoke and @ref try_invoke.
+    A hit is a lookup which found an object. Misses of
+    the type-erased @ref polystore::find are not counted.
+    Constructions include objects made by a factory, whose
+    time includes the lookups of the factory's arguments.
+    Insertions count the time taken to add the keys of an
+    object.
+*/
+struct polystore::key_statistics
+{
+    /// The type of the key
+    core::typeinfo const* type;
+
+    std::uint64_t find_hits;
+    std::uint64_t find_misses;
+    std::uint64_t get_hits;
+    std::uint64_t get_misses;
+    std::uint64_t invoke_hits;
+    std::uint64_t invoke_misses;
+
+    /// The number of objects constructed
+    std::uint64_t constructs;
+
+    /// The total time spent constructing them
+    std::uint64_t construct_ns;
+
+    /// The number of objects inserted
+    std::uint64_t inserts;
+
+    /// The total time spent inserting them
+    std::uint64_t insert_ns;
+};
+
+/** The statistics of a container
+
+    @see polystore::stats
+*/
+class polystore::statistics
 {
 public:
     std::size_t size() const noexcept
     {
-        return n_;
+        return v_.size();
     }
 
-    any& operator[](
-        std::size_t i) noexcept
+    key_statistics const& operator[](
+        std::size_t i) const noexcept
     {
-        return ps_.get(i);
+        return v_[i];
     }
 
-private:
-    friend class polystore;
+    key_statistics const* begin() const noexcept
+    {
+        return v_.data();
+    }
 
-    elements(
-        std::size_t n,
-        polystore& ps)
-        : n_(n)
-        , ps_(ps)
+    key_statistics const* end() const noexcept
     {
+        return v_.data() + v_.size();
     }
 
-    std::size_t n_;
-    polystore& ps_;
+private:
+    friend class polystore;
+
+    statistics() = default;
+
+    std::vector<key_statistics> v_;
 };
 
+#endif
+
 //------------------------------------------------
 
+/** A cached lookup of the object associated with type `T`
+
+    A handle remembers the result of looking up `T` in a
+    @ref polystore, so that repeated access does not search
+    the container again. The cached pointer is revalidated
+    against a generation counter which the container changes
+    whenever keys are inserted or cleared. In the steady state,
+    access costs one load and one comparison.
+
+    As with @ref polystore::find, a type which is a nested
+    `key_type` or one of the additional `Keys` of a stored
+    object resolves to that object.
+
+    @par Example
+    @code
+    polystore ps;
+    zlib::install_deflate_service(ps);
+    polystore::handle<zlib::deflate_service> h(ps);
+    for(;;)
+        h->deflate(st, flush);
+    @endcode
+
+    @par Thread Safety
+    Distinct objects: Safe.@n
+    Shared objects: Unsafe.
+
+    @tparam T The type of object to find.
+*/
 template<class T>
-struct polystore::any_impl : polystore::any
+class polystore::handle
 {
-    T t;
+public:
+    /** Constructor
 
-    template<class... Args>
-    explicit any_impl(Args&&... args)
-        : t(std::forward<Args>(args)...)
+        Default-constructed handles refer to no container.
+    */
+    handle() = default;
+
+    /** Constructor
+
+        The container must outlive the handle.
+
+        @param ps The container to look up `T` in.
+    */
+    explicit
+    handle(polystore const& ps)
+        : ps_(&ps)
+        , p_(ps.lookup<T>(detail::lookup_kind::find))
+        , gen_(ps.generation())
+    {
+    }
+
+    /** Return a pointer to the object, or `nullptr`
+    */
+    T*
+    get() const
+    {
+        if(! ps_)
+            return nullptr;
+        auto const gen = ps_->generation();
+        if(gen_ != gen)
+        {
+            p_ = ps_->lookup<T>(detail::lookup_kind::find);
+            gen_ = gen;
+        }
+        return p_;
+    }
+
+    /** Return `true` if the object exists
+    */
+    explicit
+    operator bool() const
+    {
+        return get() != nullptr;
+    }
+
+    /** Return a reference to the object
+
+        @par Preconditions
+        `get() != nullptr`
+    */
+    T&
+    operator*() const
+    {
+        BOOST_ASSERT(get() != nullptr);
+        return *get();
+    }
+
+    /** Return a pointer to the object
+
+        @par Preconditions
+        `get() != nullptr`
+    */
+    T*
+    operator->() const
     {
+        BOOST_ASSERT(get() != nullptr);
+        return get();
     }
-    void* get() noexcept override { return std::addressof(t); }
-    void start() override { do_start(has_start<T>{}); }
-    void stop() override { do_stop(has_stop<T>{}); }
-    void do_start(std::true_type) { t.start(); }
-    void do_start(std::false_type) {}
-    void do_stop(std::true_type) { t.stop(); }
-    void do_stop(std::false_type) {}
+
+private:
+    polystore const* ps_ = nullptr;
+    mutable T* p_ = nullptr;
+    mutable std::size_t gen_ = 0;
 };
 
 //------------------------------------------------
@@ -673,22 +2401,52 @@ template<class T> struct arg<T const&> : arg<T&> {};
 template<class T> struct arg<T const*> : arg<T*> {};
 template<class T> struct arg<T&>
 {
-    T& operator()(polystore& ps) const
+    template<class Store>
+    T& operator()(Store& ps) const
     {
-        return ps.get<T>();
+        return ps.template get<T>();
     }
 };
 template<class T> struct arg<T*>
 {
-    T* operator()(polystore& ps) const
+    template<class Store>
+    T* operator()(Store& ps) const
+    {
+        return ps.template find<T>();
+    }
+};
+
+// looks up the arguments of invoke, which
+// are counted apart from find and get
+class invoke_store
+{
+    polystore const& ps_;
+
+public:
+    explicit
+    invoke_store(polystore const& ps) noexcept
+        : ps_(ps)
+    {
+    }
+
+    template<class T>
+    T* find() const
+    {
+        return ps_.lookup<T>(lookup_kind::invoke);
+    }
+
+    template<class T>
+    T& get() const
     {
-        return ps.find<T>();
+        if(auto t = find<T>())
+            return *t;
+        throw_bad_typeid();
     }
 };
 
-template<class F, class... Args>
+template<class Store, class F, class... Args>
 auto
-invoke(polystore& ps, F&& f,
+invoke(Store& ps, F&& f,
     detail::type_list<Args...> const&) ->
         typename detail::call_traits<typename
             std::decay<F>::type>::return_type
@@ -696,6 +2454,111 @@ invoke(polystore& ps, F&& f,
     return std::forward<F>(f)(arg<Args>()(ps)...);
 }
 
+// an argument which may be missing
+template<class T> struct try_arg;
+template<class T> struct try_arg<T const&> : try_arg<T&>
+{
+    using try_arg<T&>::try_arg;
+};
+template<class T> struct try_arg<T const*> : try_arg<T*>
+{
+    using try_arg<T*>::try_arg;
+};
+template<class T> struct try_arg<T&>
+{
+    T* p;
+
+    template<class Store>
+    explicit try_arg(Store& ps)
+        : p(ps.template find<T>())
+    {
+    }
+
+    bool ok() const noexcept
+    {
+        return p != nullptr;
+    }
+
+    T& get() const noexcept
+    {
+        return *p;
+    }
+};
+template<class T> struct try_arg<T*>
+{
+    T* p;
+
+    template<class Store>
+    explicit try_arg(Store& ps)
+        : p(ps.template find<T>())
+    {
+    }
+
+    bool ok() const noexcept
+    {
+        return true;
+    }
+
+    T* get() const noexcept
+    {
+        return p;
+    }
+};
+
+template<class R>
+struct try_call
+{
+    template<class F, class Tuple, std::size_t... Is>
+    static
+    system::result<R>
+    call(F&& f, Tuple const& t, index_sequence<Is...>)
+    {
+        return std::forward<F>(f)(std::get<Is>(t).get()...);
+    }
+};
+
+template<>
+struct try_call<void>
+{
+    template<class F, class Tuple, std::size_t... Is>
+    static
+    system::result<void>
+    call(F&& f, Tuple const& t, index_sequence<Is...>)
+    {
+        std::forward<F>(f)(std::get<Is>(t).get()...);
+        return {};
+    }
+};
+
+template<class Tuple, std::size_t... Is>
+bool
+all_ok(Tuple const& t, index_sequence<Is...>) noexcept
+{
+    bool const v[] = { true, std::get<Is>(t).ok()... };
+    for(auto b : v)
+        if(! b)
+            return false;
+    return true;
+}
+
+template<class Store, class F, class... Args>
+auto
+try_invoke(Store& ps, F&& f,
+    detail::type_list<Args...> const&) ->
+        system::result<typename detail::call_traits<
+            typename std::decay<F>::type>::return_type>
+{
+    using R = typename detail::call_traits<
+        typename std::decay<F>::type>::return_type;
+    using indices = make_index_sequence<sizeof...(Args)>;
+    // braced lists are evaluated in order
+    std::tuple<try_arg<Args>...> const t{ try_arg<Args>(ps)... };
+    if(! all_ok(t, indices{}))
+        return BOOST_RTS_ERR(error::not_found);
+    return try_call<R>::call(
+        std::forward<F>(f), t, indices{});
+}
+
 } // detail
 
 /** Invoke a callable, injecting stored objects as arguments
@@ -721,11 +2584,237 @@ invoke(polystore& ps, F&& f) ->
     typename detail::call_traits<
         typename std::decay<F>::type>::return_type
 {
-    return detail::invoke(ps, std::forward<F>(f),
+    detail::invoke_store s(ps);
+    return detail::invoke(s, std::forward<F>(f),
+        typename detail::call_traits< typename
+            std::decay<F>::type>::arg_types{});
+}
+
+/** Invoke a callable with stored objects as arguments, or return an error
+
+    This is the same as @ref invoke, except that a missing
+    reference argument is reported as an error instead of
+    by throwing an exception. Every argument is looked up
+    before the callable is invoked, and it is not invoked
+    if any reference argument is missing.
+
+    @par Example
+    @code
+    auto r = try_invoke(ps, [](A& a){ return a.i; });
+    if(! r)
+        return r.error();
+    @endcode
+
+    @param ps The container to look up arguments in.
+    @param f The callable to invoke.
+    @return The result of the invocation, or
+        @ref error::not_found.
+    @throws Any exception thrown by the callable, or by a
+        factory registered with @ref polystore::register_factory
+        on first use.
+*/
+template<class F>
+auto
+try_invoke(polystore& ps, F&& f) ->
+    system::result<typename detail::call_traits<
+        typename std::decay<F>::type>::return_type>
+{
+    detail::invoke_store s(ps);
+    return detail::try_invoke(s, std::forward<F>(f),
         typename detail::call_traits< typename
             std::decay<F>::type>::arg_types{});
 }
 
+//------------------------------------------------
+
+template<class T, class F, class... Keys>
+struct polystore::lazy_impl : lazy
+{
+    // T& must be convertible to each of Keys&
+    BOOST_CORE_STATIC_ASSERT(all_true<std::is_convertible<
+        T&, Keys&>::value...>::value);
+
+    static constexpr std::size_t N = 1 + sizeof...(Keys);
+
+    F f;
+    lazy_key lk[N];
+
+    template<class F_>
+    lazy_impl(void* storage, F_&& f_)
+        : lazy(storage, ops_for<T>::value,
+            &make_impl, &destroy_impl)
+        , f(std::forward<F_>(f_))
+        , lk{
+            lazy_key{ this, &cast<T>,
+                &BOOST_CORE_TYPEID(T),
+                detail::type_slot<T>() },
+            lazy_key{ this, &cast<Keys>,
+                &BOOST_CORE_TYPEID(Keys),
+                detail::type_slot<Keys>() }... }
+    {
+    }
+
+    template<class U>
+    static void* cast(void* p)
+    {
+        return static_cast<U*>(static_cast<T*>(p));
+    }
+
+    static void* make_impl(lazy& l, polystore const& ps)
+    {
+        auto& self = static_cast<lazy_impl&>(l);
+        // includes the lookups of the arguments
+        auto const t = ps.start_timer(
+            detail::timed_kind::construct);
+        auto const p = ::new(l.storage) T(detail::invoke(ps,
+            self.f, typename detail::call_traits<F>::arg_types{}));
+        t.stop(self.lk[0].slot, BOOST_CORE_TYPEID(T));
+        return p;
+    }
+
+    static void destroy_impl(lazy& l)
+    {
+        static_cast<lazy_impl&>(l).~lazy_impl();
+    }
+};
+
+template<class F, class T, class... Keys>
+struct polystore::lazy_for<F, polystore::keyset<T, Keys...>>
+{
+    using type = lazy_impl<T, F, Keys...>;
+};
+
+template<class T, class... Keys>
+struct polystore::key_types<polystore::keyset<T, Keys...>>
+{
+    // true if any of the keys is used in this container
+    static bool any_of(polystore const& ps) noexcept
+    {
+        core::typeinfo const* const ti[] = {
+            &BOOST_CORE_TYPEID(T),
+            &BOOST_CORE_TYPEID(Keys)... };
+        return ps.has_any(ti, 1 + sizeof...(Keys));
+    }
+};
+
+/*  A per_thread registration
+
+    The keys of T resolve to the instance of the calling
+    thread. The per_thread is constructed on registration,
+    so the pointer of the record is never null and lookups
+    do not take the mutex.
+*/
+template<class T, class... Keys>
+struct polystore::local_impl : lazy
+{
+    // T& must be convertible to each of Keys&
+    BOOST_CORE_STATIC_ASSERT(all_true<std::is_convertible<
+        T&, Keys&>::value...>::value);
+
+    static constexpr std::size_t N = 2 + sizeof...(Keys);
+
+    per_thread<T> pt;
+    lazy_key lk[N];
+
+    template<class... Args>
+    explicit
+    local_impl(Args&&... args)
+        : lazy(nullptr, ops_for<per_thread<T>>::value,
+            &make_impl, &destroy_impl)
+        , pt(std::forward<Args>(args)...)
+        , lk{
+            lazy_key{ this, &self,
+                &BOOST_CORE_TYPEID(per_thread<T>),
+                detail::type_slot<per_thread<T>>() },
+            lazy_key{ this, &cast<T>,
+                &BOOST_CORE_TYPEID(T),
+                detail::type_slot<T>() },
+            lazy_key{ this, &cast<Keys>,
+                &BOOST_CORE_TYPEID(Keys),
+                detail::type_slot<Keys>() }... }
+    {
+        p.store(&pt, std::memory_order_relaxed);
+    }
+
+    static void* self(void* p)
+    {
+        return p;
+    }
+
+    template<class U>
+    static void* cast(void* p)
+    {
+        return static_cast<U*>(&static_cast<
+            per_thread<T>*>(p)->local());
+    }
+
+    static void* make_impl(lazy& l, polystore const&)
+    {
+        return &static_cast<local_impl&>(l).pt;
+    }
+
+    static void destroy_impl(lazy& l)
+    {
+        static_cast<local_impl&>(l).~local_impl();
+    }
+};
+
+template<class T, class... Keys>
+struct polystore::local_for<polystore::keyset<T, Keys...>>
+{
+    using type = local_impl<T, Keys...>;
+};
+
+template<class T, class... Keys, class... Args>
+auto
+polystore::
+emplace_thread_local(Args&&... args) ->
+    per_thread<T>&
+{
+    // Can't have Keys with nested key_type
+    BOOST_CORE_STATIC_ASSERT(
+        ! get_key<T>::value || sizeof...(Keys) == 0);
+    using impl = typename local_for<
+        keyset_t<T, Keys...>>::type;
+    if(sealed_)
+        detail::throw_logic_error(
+            "polystore: sealed");
+    auto const pv = a_.allocate(
+        sizeof(impl), alignof(impl));
+    detail::arena::guard g(a_, pv, sizeof(impl));
+    auto const p = ::new(pv) impl(
+        std::forward<Args>(args)...);
+    // destroys *p on failure
+    register_impl(*p, p->lk, impl::N);
+    g.release();
+    return p->pt;
+}
+
+template<class T, class... Keys, class F>
+void
+polystore::
+register_factory(F&& f)
+{
+    // Can't have Keys with nested key_type
+    BOOST_CORE_STATIC_ASSERT(
+        ! get_key<T>::value || sizeof...(Keys) == 0);
+    using impl = typename lazy_for<typename
+        std::decay<F>::type, keyset_t<T, Keys...>>::type;
+    if(sealed_)
+        detail::throw_logic_error(
+            "polystore: sealed");
+    auto const ps = a_.allocate(sizeof(T), alignof(T));
+    detail::arena::guard g1(a_, ps, sizeof(T));
+    auto const pv = a_.allocate(
+        sizeof(impl), alignof(impl));
+    detail::arena::guard g2(a_, pv, sizeof(impl));
+    auto const p = ::new(pv) impl(ps, std::forward<F>(f));
+    // destroys *p on failure
+    register_impl(*p, p->lk, impl::N);
+    g2.release();
+    g1.release();
+}
+
 } // rts
 } // boost
 
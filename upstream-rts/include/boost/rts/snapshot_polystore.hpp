@@ -0,0 +1,403 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_SNAPSHOT_POLYSTORE_HPP
+#define BOOST_RTS_SNAPSHOT_POLYSTORE_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/atomic_shared_ptr.hpp>
+#include <boost/rts/detail/call_traits.hpp>
+#include <boost/rts/detail/except.hpp>
+#include <boost/rts/polystore.hpp>
+#include <boost/core/typeinfo.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace rts {
+
+/** A container of type-erased objects which is replaced as a whole
+
+    Readers obtain the current @ref snapshot with @ref load,
+    an immutable set of objects which offers the lookup
+    interface of @ref polystore, and hold it for as long as
+    they use it. A writer calls @ref update to build the next
+    snapshot from a copy of the current one, and publishes it
+    with an atomic pointer swap. Readers are never paused:
+    those holding the old snapshot keep using it until they
+    release it, and later calls to @ref load return the new
+    one.
+
+    The objects are reference counted. A new snapshot shares
+    every object which the update did not replace or erase,
+    so an update costs one allocation per new object plus
+    the rebuilt key index. An object is destroyed when the
+    last snapshot referring to it is released.
+
+    Objects are shared between threads through the snapshots,
+    so any member functions called on them concurrently must
+    be thread-safe.
+
+    @par Example
+    @code
+    snapshot_polystore sp;
+    sp.update([](snapshot_polystore::editor& e)
+        {
+            e.emplace<config>(load_config());
+            e.emplace<router>();
+        });
+
+    // on any thread
+    auto s = sp.load();
+    s->get<router>().route(s->get<config>(), req);
+
+    // reload, while readers continue
+    sp.update([](snapshot_polystore::editor& e)
+        {
+            e.replace<config>(load_config());
+        });
+    @endcode
+
+    @see polystore
+*/
+class snapshot_polystore
+{
+    struct entry;
+
+    template<class T, class KS>
+    struct entry_impl;
+
+    template<class T, class... Keys>
+    using keyset_t = polystore::keyset_t<T, Keys...>;
+
+public:
+    class snapshot;
+    class editor;
+
+    /** A shared, immutable snapshot
+    */
+    using snapshot_ptr = std::shared_ptr<snapshot const>;
+
+    snapshot_polystore(snapshot_polystore const&) = delete;
+    snapshot_polystore& operator=(snapshot_polystore const&) = delete;
+
+    /** Destructor
+
+        Snapshots which are still held remain valid.
+    */
+    BOOST_RTS_DECL
+    ~snapshot_polystore();
+
+    /** Constructor
+
+        The current snapshot is initially empty.
+
+        @throws std::bad_alloc on allocation failure.
+    */
+    BOOST_RTS_DECL
+    snapshot_polystore();
+
+    /** Return the current snapshot
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor.
+
+        @return The most recently published snapshot, which
+            is never null.
+    */
+    BOOST_RTS_DECL
+    snapshot_ptr
+    load() const noexcept;
+
+    /** Build and publish the next snapshot
+
+        An @ref editor holding the objects of the current
+        snapshot is passed to `f`, which may insert, replace
+        and erase objects. Afterwards the key index of the new
+        snapshot is built and the snapshot is published.
+        Updates are serialized by a mutex; readers do not
+        wait for it.
+
+        @par Exception Safety
+        Strong guarantee. If `f` throws, or two objects of the
+        new snapshot share a key, nothing is published.
+
+        @par Thread Safety
+        May be called concurrently with any member function
+        other than the destructor.
+
+        @throws std::invalid_argument if two objects share a key.
+        @param f A callable invoked as `f(e)`, where `e` is an
+            lvalue of type @ref editor.
+    */
+    template<class F>
+    void
+    update(F&& f)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        editor e(*load());
+        std::forward<F>(f)(e);
+        publish(e);
+    }
+
+private:
+    BOOST_RTS_DECL void publish(editor& e);
+
+    std::mutex m_; // serializes writers
+    detail::atomic_shared_ptr<snapshot const> cur_;
+};
+
+//------------------------------------------------
+
+// an object shared by snapshots, with its keys
+struct snapshot_polystore::entry
+{
+    polystore::key const* k = nullptr;
+    std::size_t n = 0;
+};
+
+/** An immutable set of objects published by @ref snapshot_polystore
+
+    Lookups use a sealed @ref polystore index, so each one
+    has the same cost as in a sealed @ref polystore.
+
+    @par Thread Safety
+    Distinct objects: Safe.@n
+    Shared objects: Safe.
+*/
+class snapshot_polystore::snapshot
+{
+public:
+    /** Return a pointer to the object associated with type `T`, or `nullptr`
+
+        @tparam T The type of object to find.
+        @return A pointer to the associated object, or `nullptr` if none exists.
+    */
+    template<class T>
+    T*
+    find() const noexcept
+    {
+        return ps_.find<T>();
+    }
+
+    /** Return a pointer to the object associated with a type, or `nullptr`
+
+        @param ti The type information of the key to find.
+        @return A pointer to the associated object, or `nullptr` if none exists.
+    */
+    void*
+    find(core::typeinfo const& ti) const noexcept
+    {
+        return ps_.find(ti);
+    }
+
+    /** Return a reference to the object associated with type T
+
+        @throws std::bad_typeid
+        If no object associated with type `T` is present.
+        @tparam T The type of object to retrieve.
+        @return A reference to the associated object.
+    */
+    template<class T>
+    T&
+    get() const
+    {
+        return ps_.get<T>();
+    }
+
+    /** Return the number of objects
+    */
+    std::size_t
+    size() const noexcept
+    {
+        return v_.size();
+    }
+
+private:
+    friend class snapshot_polystore;
+
+    snapshot() = default;
+
+    std::vector<std::shared_ptr<entry const>> v_;
+    polystore ps_;
+};
+
+//------------------------------------------------
+
+/** The objects of the next snapshot, while an update builds it
+
+    Objects are identified by their own type. Keys are
+    checked for duplicates when the snapshot is published.
+
+    @see snapshot_polystore::update
+*/
+class snapshot_polystore::editor
+{
+public:
+    editor(editor const&) = delete;
+    editor& operator=(editor const&) = delete;
+
+    /** Construct and insert an object
+
+        This has the same requirements as
+        @ref polystore::emplace.
+
+        @tparam T The type of object to construct and insert.
+        @tparam Keys Optional key types associated with the object.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the inserted object.
+    */
+    template<class T, class... Keys, class... Args>
+    T&
+    emplace(Args&&... args)
+    {
+        auto p = make<T, Keys...>(
+            std::forward<Args>(args)...);
+        auto& t = p->t;
+        v_.push_back(std::move(p));
+        return t;
+    }
+
+    /** Replace the object of type `T` with a new one
+
+        The new object takes the place of the old one in the
+        next snapshot. Snapshots already published keep the
+        old object, which is destroyed when the last of them
+        is released.
+
+        @throws std::bad_typeid if there is no object of
+            type `T`.
+        @tparam T The type of object to replace.
+        @tparam Keys Optional key types associated with the
+            new object.
+        @param args Arguments forwarded to the constructor of `T`.
+        @return A reference to the new object.
+    */
+    template<class T, class... Keys, class... Args>
+    T&
+    replace(Args&&... args)
+    {
+        auto const i = index_of(BOOST_CORE_TYPEID(T));
+        if(i == v_.size())
+            detail::throw_bad_typeid();
+        auto p = make<T, Keys...>(
+            std::forward<Args>(args)...);
+        auto& t = p->t;
+        v_[i] = std::move(p);
+        return t;
+    }
+
+    /** Remove the object of type `T` from the next snapshot
+
+        @tparam T The type of object to erase.
+        @return `true` if an object was erased, or `false` if
+            there is no object of type `T`.
+    */
+    template<class T>
+    bool
+    erase()
+    {
+        auto const i = index_of(BOOST_CORE_TYPEID(T));
+        if(i == v_.size())
+            return false;
+        v_.erase(v_.begin() + i);
+        return true;
+    }
+
+    /** Return a pointer to the object of type `T`, or `nullptr`
+
+        This finds objects by their own type only.
+
+        @tparam T The type of object to find.
+    */
+    template<class T>
+    T*
+    find() const noexcept
+    {
+        auto const i = index_of(BOOST_CORE_TYPEID(T));
+        if(i == v_.size())
+            return nullptr;
+        return static_cast<T*>(v_[i]->k[0].p);
+    }
+
+private:
+    friend class snapshot_polystore;
+
+    explicit
+    editor(snapshot const& s)
+        : v_(s.v_)
+    {
+    }
+
+    template<class T, class... Keys, class... Args>
+    std::shared_ptr<entry_impl<T, keyset_t<T, Keys...>>>
+    make(Args&&... args)
+    {
+        return std::make_shared<entry_impl<
+            T, keyset_t<T, Keys...>>>(
+                std::forward<Args>(args)...);
+    }
+
+    BOOST_RTS_DECL
+    std::size_t
+    index_of(core::typeinfo const& ti) const noexcept;
+
+    std::vector<std::shared_ptr<entry const>> v_;
+};
+
+//------------------------------------------------
+
+template<class T, class KS>
+struct snapshot_polystore::entry_impl : entry
+{
+    T t;
+    KS ks;
+
+    template<class... Args>
+    explicit
+    entry_impl(Args&&... args)
+        : t(std::forward<Args>(args)...)
+        , ks(t)
+    {
+        k = ks.kn;
+        n = KS::N;
+    }
+};
+
+/** Invoke a callable, injecting objects of a snapshot as arguments
+
+    This has the same effects as the @ref polystore
+    overload.
+
+    @param s The snapshot to take arguments from.
+    @param f The callable to invoke.
+    @return The result of the invocation.
+    @throws std::bad_typeid if any reference argument
+        types are not found in the snapshot.
+*/
+template<class F>
+auto
+invoke(snapshot_polystore::snapshot const& s, F&& f) ->
+    typename detail::call_traits<
+        typename std::decay<F>::type>::return_type
+{
+    return detail::invoke(s, std::forward<F>(f),
+        typename detail::call_traits< typename
+            std::decay<F>::type>::arg_types{});
+}
+
+} // rts
+} // boost
+
+#endif
@@ -0,0 +1,408 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#ifndef BOOST_RTS_STATIC_POLYSTORE_HPP
+#define BOOST_RTS_STATIC_POLYSTORE_HPP
+
+#include <boost/rts/detail/config.hpp>
+#include <boost/rts/detail/call_traits.hpp>
+#include <boost/rts/detail/type_traits.hpp>
+#include <boost/rts/polystore.hpp>
+#include <boost/core/detail/static_assert.hpp>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace rts {
+
+namespace detail {
+
+// the nested key_type of T, or void
+template<class T, class = void>
+struct static_key
+{
+    using type = void;
+};
+
+template<class T>
+struct static_key<T, void_t<typename T::key_type>>
+{
+    using type = typename T::key_type;
+};
+
+// true if an object of type T is found by key K
+template<class K, class T>
+using static_match = std::integral_constant<bool,
+    std::is_same<K, T>::value ||
+    std::is_same<K, typename static_key<T>::type>::value>;
+
+// index of the first of Ts found by K, or sizeof...(Ts)
+template<class K, class... Ts>
+struct static_index
+    : std::integral_constant<std::size_t, 0>
+{
+};
+
+template<class K, class T, class... Ts>
+struct static_index<K, T, Ts...>
+    : std::integral_constant<std::size_t,
+        static_match<K, T>::value ? 0 :
+            1 + static_index<K, Ts...>::value>
+{
+};
+
+// number of Ts found by K
+template<class K, class... Ts>
+struct static_count
+    : std::integral_constant<std::size_t, 0>
+{
+};
+
+template<class K, class T, class... Ts>
+struct static_count<K, T, Ts...>
+    : std::integral_constant<std::size_t,
+        static_match<K, T>::value +
+            static_count<K, Ts...>::value>
+{
+};
+
+// true if each key of T finds only T
+template<class T, class... Ts>
+using static_unique = std::integral_constant<bool,
+    static_count<T, Ts...>::value == 1 && (
+        std::is_void<typename static_key<T>::type>::value ||
+        static_count<typename static_key<T>::type,
+            Ts...>::value == 1)>;
+
+/*  Objects as members, so they are constructed
+    in order and destroyed in reverse order.
+    std::tuple leaves the order unspecified.
+*/
+template<class... Ts>
+struct static_storage
+{
+    void start() {}
+    void stop() {}
+};
+
+template<class T, class... Ts>
+struct static_storage<T, Ts...>
+{
+    T first;
+    static_storage<Ts...> rest;
+
+    static_storage()
+        : first()
+        , rest()
+    {
+    }
+
+    void
+    start()
+    {
+        do_start(first, has_start<T>{});
+        // stop this one if a later one throws
+        struct undo
+        {
+            T& t;
+            bool ok = false;
+
+            explicit undo(T& t_) noexcept
+                : t(t_)
+            {
+            }
+
+            ~undo()
+            {
+                if(! ok)
+                    do_stop(t, has_stop<T>{});
+            }
+        };
+        undo u(first);
+        rest.start();
+        u.ok = true;
+    }
+
+    void
+    stop()
+    {
+        rest.stop();
+        do_stop(first, has_stop<T>{});
+    }
+
+    static void do_start(T& t, std::true_type) { t.start(); }
+    static void do_start(T&, std::false_type) {}
+    static void do_stop(T& t, std::true_type) { t.stop(); }
+    static void do_stop(T&, std::false_type) {}
+};
+
+template<std::size_t I>
+struct static_at
+{
+    template<class S>
+    static
+    auto
+    get(S& s) noexcept ->
+        decltype(static_at<I - 1>::get(s.rest))
+    {
+        return static_at<I - 1>::get(s.rest);
+    }
+};
+
+template<>
+struct static_at<0>
+{
+    template<class S>
+    static
+    auto
+    get(S& s) noexcept ->
+        decltype((s.first))
+    {
+        return s.first;
+    }
+};
+
+} // detail
+
+/** A container of objects whose types are known at compile time
+
+    This offers the lookup interface of @ref polystore for a
+    fixed set of types. Every object is a direct member of the
+    container, so @ref get, @ref find and @ref invoke resolve
+    to a member access at compile time, with no table and no
+    allocation. As with @ref polystore, a type may specify a
+    nested `key_type` under which it is also found.
+
+    The objects are default-constructed in the order of
+    `Ts`, and destroyed in the reverse order. No two types
+    may share a key.
+
+    Libraries which only accept a `polystore&` can be given
+    @ref dynamic, a @ref polystore which refers to the same
+    objects and to which further objects may be added.
+
+    @par Example
+    @code
+    struct A { int i = 1; };
+    struct B { char c = '2'; };
+    static_polystore<A, B> ps;
+    assert(ps.get<A>().i == 1);
+    invoke(ps, [](A& a, B const& b){ a.i = b.c; });
+    zlib::install_deflate_service(ps.dynamic());
+    @endcode
+
+    @par Thread Safety
+    `const` member function calls are thread-safe.
+    Calls to non-`const` member functions must not run concurrently
+    with other member functions on the same object.
+
+    @tparam Ts The types of the stored objects.
+*/
+template<class... Ts>
+class static_polystore
+{
+    // Each key may be used only once
+    BOOST_CORE_STATIC_ASSERT(detail::all_true<
+        detail::static_unique<Ts, Ts...>::value...>::value);
+
+public:
+    static_polystore(static_polystore const&) = delete;
+    static_polystore& operator=(static_polystore const&) = delete;
+
+    /** Destructor
+
+        The view returned by @ref dynamic is destroyed first,
+        with any objects added to it. Then the stored objects
+        are destroyed in the reverse order of `Ts`.
+    */
+    ~static_polystore() = default;
+
+    /** Constructor
+
+        Each object is default-constructed, in the order
+        of `Ts`.
+    */
+    static_polystore() = default;
+
+    /** Return a pointer to the object associated with type `T`, or `nullptr`
+
+        @par Complexity
+        Constant. The lookup is resolved at compile time.
+
+        @tparam T The type of object to find.
+        @return A pointer to the associated object, or
+            `nullptr` if none of `Ts` is found by `T`.
+    */
+    template<class T>
+    T*
+    find() const noexcept
+    {
+        return find_impl<T>(std::integral_constant<bool,
+            (detail::static_index<T, Ts...>::value <
+                sizeof...(Ts))>{});
+    }
+
+    /** Return a reference to the object associated with type `T`
+
+        @par Constraints
+        One of `Ts` must be `T` or have `T` as its `key_type`.
+
+        @par Complexity
+        Constant. The lookup is resolved at compile time.
+
+        @tparam T The type of object to retrieve.
+        @return A reference to the associated object.
+    */
+    template<class T>
+    T&
+    get() const noexcept
+    {
+        // T must be stored
+        BOOST_CORE_STATIC_ASSERT(
+            detail::static_index<T, Ts...>::value <
+                sizeof...(Ts));
+        return *find<T>();
+    }
+
+    /** Invoke `start` on each object in the order of `Ts`
+
+        Objects without a member `void start()` are skipped.
+        If an object throws, the objects already started are
+        stopped in reverse order and the exception is
+        propagated.
+    */
+    void
+    start()
+    {
+        s_.start();
+    }
+
+    /** Invoke `stop` on each object in the reverse order of `Ts`
+
+        Objects without a member `void stop()` are skipped.
+    */
+    void
+    stop()
+    {
+        s_.stop();
+    }
+
+    /** Return a polystore which refers to the stored objects
+
+        The returned container finds every stored object under
+        its type and its nested `key_type`, for code which only
+        accepts a @ref polystore. It does not own these objects,
+        which cannot be erased or replaced through it. Objects
+        inserted into it are owned by it, and are destroyed
+        before the stored objects. The container is built on
+        the first call, which allocates.
+
+        @par Exception Safety
+        Strong guarantee.
+
+        @par Thread Safety
+        Not thread-safe.
+
+        @throws std::bad_alloc on allocation failure.
+        @return A reference to the container.
+    */
+    polystore&
+    dynamic()
+    {
+        if(! built_)
+        {
+            build(detail::make_index_sequence<
+                sizeof...(Ts)>{});
+            built_ = true;
+        }
+        return ps_;
+    }
+
+private:
+    template<class T>
+    T*
+    find_impl(std::true_type) const noexcept
+    {
+        return &static_cast<T&>(detail::static_at<
+            detail::static_index<T, Ts...>::value>::get(s_));
+    }
+
+    template<class T>
+    T*
+    find_impl(std::false_type) const noexcept
+    {
+        return nullptr;
+    }
+
+    template<std::size_t... Is>
+    void
+    build(detail::index_sequence<Is...>)
+    {
+        struct undo
+        {
+            polystore& ps;
+            bool ok = false;
+
+            explicit undo(polystore& ps_) noexcept
+                : ps(ps_)
+            {
+            }
+
+            ~undo()
+            {
+                if(! ok)
+                    ps.clear();
+            }
+        };
+        undo u(ps_);
+        int const v[] = { 0, (
+            insert(detail::static_at<Is>::get(s_)), 0)... };
+        (void)v;
+        u.ok = true;
+    }
+
+    template<class T>
+    void
+    insert(T& t)
+    {
+        polystore::keyset_t<T> ks(t);
+        ps_.insert_keys(ks.kn, ks.N);
+    }
+
+    mutable detail::static_storage<Ts...> s_;
+    polystore ps_;
+    bool built_ = false;
+};
+
+/** Invoke a callable, injecting stored objects as arguments
+
+    This is the same as the overload for @ref polystore,
+    with every lookup resolved at compile time. A reference
+    argument whose type is not stored is a compile error.
+
+    @param ps The container to look up arguments in.
+    @param f The callable to invoke.
+    @return The result of the invocation.
+*/
+template<class... Ts, class F>
+auto
+invoke(static_polystore<Ts...>& ps, F&& f) ->
+    typename detail::call_traits<
+        typename std::decay<F>::type>::return_type
+{
+    return detail::invoke(ps, std::forward<F>(f),
+        typename detail::call_traits< typename
+            std::decay<F>::type>::arg_types{});
+}
+
+} // rts
+} // boost
+
+#endif
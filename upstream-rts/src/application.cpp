@@ -8,9 +8,11 @@
 //
 
 #include <boost/rts/application.hpp>
+#include <boost/rts/detail/allocator.hpp>
 #include <boost/rts/detail/except.hpp>
 #include <boost/assert.hpp>
 #include <mutex>
+#include <new>
 #include <vector>
 
 namespace boost {
@@ -31,6 +33,19 @@ struct application::impl
     state st = state::none;
 };
 
+namespace {
+
+// constructs a T with storage from mr
+template<class T>
+T*
+new_from(detail::memory_resource* mr)
+{
+    return ::new(detail::allocate(
+        mr, sizeof(T), alignof(T))) T();
+}
+
+} // (anon)
+
 application::
 ~application()
 {
@@ -43,12 +58,22 @@ application::
             detail::throw_invalid_argument();
         }
     }
-    delete impl_;
+    impl_->~impl();
+    detail::deallocate(resource(), impl_,
+        sizeof(impl), alignof(impl));
 }
 
 application::
 application()
-    : impl_(new impl)
+    : impl_(new_from<impl>(nullptr))
+{
+}
+
+application::
+application(
+    container::pmr::memory_resource* mr)
+    : polystore(mr)
+    , impl_(new_from<impl>(mr))
 {
 }
 
@@ -77,11 +102,11 @@ start()
                 std::lock_guard<
                     std::mutex> lock(self_.impl_->m);
                 BOOST_ASSERT(
-                    self_.impl_->st == state::stopping);
+                    self_.impl_->st == state::starting);
                 self_.impl_->st = state::stopping;
             }
             // stop what we started
-            auto v = self_.get_elements();
+            auto v = self_.get_hooks();
             while(n_-- > 0)
                 v[n_].stop();
             {
@@ -93,12 +118,15 @@ start()
 
         void apply()
         {
-            auto v = self_.get_elements();
-            while(n_ < v.size())
+            // a start function may make objects
+            // with factories, which are started too
+            while(n_ < self_.get_hooks().size())
             {
-                v[n_].stop();
+                self_.get_hooks()[n_].start();
                 ++n_;
             }
+            // the set of parts is final now
+            self_.seal();
             n_ = 0;
             std::lock_guard<
                 std::mutex> lock(self_.impl_->m);
@@ -124,7 +152,7 @@ stop()
         impl_->st = state::stopping;
     }
 
-    auto v = get_elements();
+    auto v = get_hooks();
     for(std::size_t i = v.size(); i--;)
         v[i].stop();
 
@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/concurrent_polystore.hpp>
+#include <algorithm>
+#include <new>
+
+namespace boost {
+namespace rts {
+
+/*  Every key is in hash_table, and keys whose type
+    slot is below the size of slot_table are also in
+    slot_table, so a lookup by type slot which falls
+    outside of it goes to hash_table. Slots are
+    numbered across the whole process, so as in
+    detail::slot_table the size of slot_table is kept
+    under a limit which is a multiple of the number of
+    keys, and both tables stay proportional to the
+    contents of the container.
+
+    Both tables are written only while m_ is held. An
+    entry becomes visible to readers with a release
+    store, after everything it refers to has been
+    written; a grown table becomes visible the same
+    way, after all of its entries have been copied.
+*/
+
+struct concurrent_polystore::hash_table
+{
+    struct entry
+    {
+        std::atomic<core::typeinfo const*> ti;
+        std::size_t hash;
+        std::size_t slot;
+        void* p;
+    };
+
+    std::size_t cap;
+    hash_table* prev;
+    entry* v;
+};
+
+namespace {
+
+template<class Table, class Elem>
+Table*
+make_table(std::size_t n)
+{
+    auto const t = static_cast<Table*>(::operator new(
+        sizeof(Table) + n * sizeof(Elem)));
+    auto const v = reinterpret_cast<Elem*>(t + 1);
+    for(std::size_t i = 0; i < n; ++i)
+        ::new(v + i) Elem();
+    t->v = v;
+    t->prev = nullptr;
+    return t;
+}
+
+} // (anon)
+
+concurrent_polystore::
+~concurrent_polystore()
+{
+    auto s = slots_.load(std::memory_order_relaxed);
+    while(s)
+    {
+        auto const prev = s->prev;
+        ::operator delete(s);
+        s = prev;
+    }
+    auto h = hash_.load(std::memory_order_relaxed);
+    while(h)
+    {
+        auto const prev = h->prev;
+        ::operator delete(h);
+        h = prev;
+    }
+}
+
+void*
+concurrent_polystore::
+find(core::typeinfo const& ti) const noexcept
+{
+    auto const t = hash_.load(std::memory_order_acquire);
+    if(! t)
+        return nullptr;
+    auto const hash = polystore::hash(ti);
+    auto const mask = t->cap - 1;
+    for(auto i = hash & mask;; i = (i + 1) & mask)
+    {
+        auto const& e = t->v[i];
+        auto const eti = e.ti.load(std::memory_order_acquire);
+        if(! eti)
+            return nullptr;
+        if( e.hash == hash && (
+                eti == &ti || *eti == ti))
+            return e.p;
+    }
+}
+
+void
+concurrent_polystore::
+reserve(
+    std::size_t max_slot,
+    std::size_t n)
+{
+    auto h = hash_.load(std::memory_order_relaxed);
+    // keep the load factor at or below one half
+    if(! h || 2 * (n_ + n) > h->cap)
+    {
+        std::size_t cap = h ? 2 * h->cap : 16;
+        while(2 * (n_ + n) > cap)
+            cap *= 2;
+        auto const t = make_table<hash_table,
+            hash_table::entry>(cap);
+        t->cap = cap;
+        auto const mask = cap - 1;
+        if(h)
+        {
+            for(std::size_t k = 0; k < h->cap; ++k)
+            {
+                auto const& e = h->v[k];
+                auto const ti = e.ti.load(
+                    std::memory_order_relaxed);
+                if(! ti)
+                    continue;
+                auto i = e.hash & mask;
+                while(t->v[i].ti.load(
+                        std::memory_order_relaxed))
+                    i = (i + 1) & mask;
+                t->v[i].hash = e.hash;
+                t->v[i].slot = e.slot;
+                t->v[i].p = e.p;
+                t->v[i].ti.store(ti,
+                    std::memory_order_relaxed);
+            }
+        }
+        t->prev = h;
+        hash_.store(t, std::memory_order_release);
+        h = t;
+    }
+
+    // the limit grows geometrically, so that
+    // slot_table is replaced only a logarithmic
+    // number of times
+    auto const m = 4 * (n_ + n);
+    if(limit_ < m)
+        limit_ = (std::max)(2 * limit_, m);
+    if(limit_ < min_direct)
+        limit_ = min_direct;
+
+    auto const s = slots_.load(std::memory_order_relaxed);
+    auto const old = s ? s->size : 0;
+    auto const want = (std::min)(max_slot + 1, limit_);
+    if(old < want)
+    {
+        auto const size = (std::max)(want,
+            (std::min)(old ? 2 * old : 16, limit_));
+        auto const t = make_table<slot_table,
+            std::atomic<void*>>(size);
+        t->size = size;
+        for(std::size_t i = 0; i < old; ++i)
+            t->v[i].store(s->v[i].load(
+                std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+        // keys which were only in hash_table
+        for(std::size_t k = 0; k < h->cap; ++k)
+        {
+            auto const& e = h->v[k];
+            if( e.ti.load(std::memory_order_relaxed) &&
+                e.slot >= old && e.slot < size)
+                t->v[e.slot].store(e.p,
+                    std::memory_order_relaxed);
+        }
+        t->prev = s;
+        slots_.store(t, std::memory_order_release);
+    }
+}
+
+void
+concurrent_polystore::
+publish(
+    core::typeinfo const& ti,
+    polystore::key const* k,
+    std::size_t n)
+{
+    // a constructor which inserted other objects
+    // may have used up the reserved capacity. The
+    // object is not visible to readers yet, so if
+    // growing fails it is erased and the insert
+    // can be retried.
+    std::size_t max_slot = 0;
+    for(std::size_t i = 0; i < n; ++i)
+        if(max_slot < k[i].slot)
+            max_slot = k[i].slot;
+    {
+        core::typeinfo const* const own[] = { &ti };
+        polystore::undo_emplace u(ps_, own, 1);
+        reserve(max_slot, n);
+        u.release();
+    }
+
+    // nothing below can fail
+
+    auto const s = slots_.load(std::memory_order_relaxed);
+    auto const h = hash_.load(std::memory_order_relaxed);
+    auto const mask = h->cap - 1;
+    for(std::size_t j = 0; j < n; ++j)
+    {
+        if(k[j].slot < s->size)
+            s->v[k[j].slot].store(k[j].p,
+                std::memory_order_release);
+        auto const hash = polystore::hash(*k[j].ti);
+        auto i = hash & mask;
+        while(h->v[i].ti.load(
+                std::memory_order_relaxed))
+            i = (i + 1) & mask;
+        h->v[i].hash = hash;
+        h->v[i].slot = k[j].slot;
+        h->v[i].p = k[j].p;
+        h->v[i].ti.store(k[j].ti,
+            std::memory_order_release);
+        ++n_;
+    }
+}
+
+} // rts
+} // boost
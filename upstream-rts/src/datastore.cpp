@@ -13,5 +13,52 @@
 namespace boost {
 namespace rts {
 
+datastore_pool::
+cache::
+~cache()
+{
+    for(auto ds : v)
+        delete ds;
+}
+
+datastore_pool::
+cache::
+cache(std::size_t max)
+{
+    // so that release never allocates
+    v.reserve(max);
+}
+
+auto
+datastore_pool::
+acquire() ->
+    pointer
+{
+    auto& c = caches_.local();
+    if(! c.v.empty())
+    {
+        auto const ds = c.v.back();
+        c.v.pop_back();
+        return pointer(ds, deleter(*this));
+    }
+    return pointer(new datastore(
+        parent_, mr_), deleter(*this));
+}
+
+void
+datastore_pool::
+release(datastore* ds) noexcept
+{
+    ds->reset();
+    // a thread which never acquired has no cache
+    auto const c = caches_.find();
+    if(c && c->v.size() < max_)
+    {
+        c->v.push_back(ds);
+        return;
+    }
+    delete ds;
+}
+
 } // rts
 } // boost
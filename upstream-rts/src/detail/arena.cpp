@@ -0,0 +1,270 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/detail/arena.hpp>
+#include <boost/assert.hpp>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+namespace {
+
+constexpr std::size_t min_chunk = 256;
+constexpr std::size_t max_chunk = 64 * 1024;
+
+char*
+align_up(char* p, std::size_t align) noexcept
+{
+    auto const u = reinterpret_cast<std::uintptr_t>(p);
+    return p + ((align - (u & (align - 1))) & (align - 1));
+}
+
+} // (anon)
+
+struct arena::chunk
+{
+    chunk* next;
+    std::size_t size;
+
+    char*
+    begin() noexcept
+    {
+        return reinterpret_cast<char*>(this + 1);
+    }
+
+    char*
+    end() noexcept
+    {
+        return begin() + size;
+    }
+};
+
+struct arena::free_block
+{
+    free_block* next;
+    std::size_t size;
+};
+
+arena::
+~arena()
+{
+    clear();
+}
+
+arena::
+arena(
+    arena&& other) noexcept
+    : mr_(other.mr_)
+{
+    swap(other);
+}
+
+void
+arena::
+swap(arena& other) noexcept
+{
+    std::swap(mr_, other.mr_);
+    std::swap(head_, other.head_);
+    std::swap(spare_, other.spare_);
+    std::swap(free_, other.free_);
+    std::swap(pos_, other.pos_);
+    std::swap(end_, other.end_);
+    std::swap(last_, other.last_);
+    std::swap(next_, other.next_);
+}
+
+void*
+arena::
+allocate(
+    std::size_t size,
+    std::size_t align)
+{
+    BOOST_ASSERT((align & (align - 1)) == 0);
+    // first fit from the free list
+    for(auto pb = &free_; *pb; pb = &(*pb)->next)
+    {
+        auto const b = *pb;
+        if( b->size >= size &&
+            (reinterpret_cast<std::uintptr_t>(
+                b) & (align - 1)) == 0)
+        {
+            *pb = b->next;
+            return b;
+        }
+    }
+
+    if(pos_)
+    {
+        auto const p = align_up(pos_, align);
+        if(p <= end_ && size <= static_cast<
+            std::size_t>(end_ - p))
+        {
+            pos_ = p + size;
+            last_ = p;
+            return p;
+        }
+    }
+
+    if(auto const p = from_spare(size, align))
+        return p;
+
+    // worst case padding for the alignment
+    std::size_t const need = size + align - 1;
+    if(next_ < min_chunk)
+        next_ = min_chunk;
+    bool const big = need > next_ / 2;
+    std::size_t const n = big ? need : next_;
+    auto const c = static_cast<chunk*>(detail::allocate(
+        mr_, sizeof(chunk) + n, alignof(chunk)));
+    c->size = n;
+    auto const p = align_up(c->begin(), align);
+    if(big && head_)
+    {
+        // dedicated chunk: keep filling the current one
+        c->next = head_->next;
+        head_->next = c;
+        last_ = nullptr;
+        return p;
+    }
+    c->next = head_;
+    head_ = c;
+    pos_ = p + size;
+    end_ = c->end();
+    last_ = p;
+    if(! big && next_ < max_chunk)
+        next_ *= 2;
+    return p;
+}
+
+void
+arena::
+reserve(std::size_t size)
+{
+    if(pos_ && size <= static_cast<
+            std::size_t>(end_ - pos_))
+        return;
+    if(from_spare(size, 1))
+    {
+        // make it all available again
+        pos_ = head_->begin();
+        last_ = nullptr;
+        return;
+    }
+    if(next_ < min_chunk)
+        next_ = min_chunk;
+    std::size_t const n =
+        size > next_ ? size : next_;
+    auto const c = static_cast<chunk*>(detail::allocate(
+        mr_, sizeof(chunk) + n, alignof(chunk)));
+    c->size = n;
+    c->next = head_;
+    head_ = c;
+    pos_ = c->begin();
+    end_ = c->end();
+    last_ = nullptr;
+    if(n == next_ && next_ < max_chunk)
+        next_ *= 2;
+}
+
+void
+arena::
+deallocate(
+    void* p,
+    std::size_t size) noexcept
+{
+    if(p == last_)
+    {
+        deallocate(p);
+        return;
+    }
+    if( size < sizeof(free_block) ||
+        (reinterpret_cast<std::uintptr_t>(p) &
+            (alignof(free_block) - 1)) != 0)
+        return;
+    free_ = ::new(p) free_block{ free_, size };
+}
+
+std::size_t
+arena::
+allocated() const noexcept
+{
+    std::size_t n = 0;
+    for(auto c = head_; c; c = c->next)
+        n += sizeof(chunk) + c->size;
+    for(auto c = spare_; c; c = c->next)
+        n += sizeof(chunk) + c->size;
+    return n;
+}
+
+void
+arena::
+clear() noexcept
+{
+    reset();
+    while(spare_)
+    {
+        auto const next = spare_->next;
+        detail::deallocate(mr_, spare_,
+            sizeof(chunk) + spare_->size, alignof(chunk));
+        spare_ = next;
+    }
+    next_ = 0;
+}
+
+void
+arena::
+reset() noexcept
+{
+    // the oldest chunk ends up first, so the
+    // chunks are used again in the same order
+    while(head_)
+    {
+        auto const next = head_->next;
+        head_->next = spare_;
+        spare_ = head_;
+        head_ = next;
+    }
+    free_ = nullptr;
+    pos_ = nullptr;
+    end_ = nullptr;
+    last_ = nullptr;
+}
+
+char*
+arena::
+from_spare(
+    std::size_t size,
+    std::size_t align) noexcept
+{
+    // first fit, which becomes the current chunk
+    for(auto pc = &spare_; *pc; pc = &(*pc)->next)
+    {
+        auto const c = *pc;
+        auto const p = align_up(c->begin(), align);
+        if( p > c->end() || size > static_cast<
+                std::size_t>(c->end() - p))
+            continue;
+        *pc = c->next;
+        c->next = head_;
+        head_ = c;
+        pos_ = p + size;
+        end_ = c->end();
+        last_ = p;
+        return p;
+    }
+    return nullptr;
+}
+
+} // detail
+} // rts
+} // boost
@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/detail/cpu.hpp>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+std::size_t
+core_count() noexcept
+{
+    static std::size_t const n = []
+        {
+            std::size_t const n =
+                std::thread::hardware_concurrency();
+            return n > 0 ? n : 1;
+        }();
+    return n;
+}
+
+std::size_t
+current_core() noexcept
+{
+#if defined(__linux__)
+    // usually served by the vDSO, without a system call
+    int const n = ::sched_getcpu();
+    return n < 0 ? 0 : static_cast<std::size_t>(n);
+#elif defined(_WIN32)
+    return ::GetCurrentProcessorNumber();
+#else
+    return 0;
+#endif
+}
+
+} // detail
+} // rts
+} // boost
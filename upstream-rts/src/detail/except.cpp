@@ -10,6 +10,7 @@
 #include <boost/rts/detail/config.hpp>
 #include <boost/rts/detail/except.hpp>
 #include <boost/throw_exception.hpp>
+#include <new>
 #include <stdexcept>
 #include <typeinfo>
 
@@ -17,6 +18,13 @@ namespace boost {
 namespace rts {
 namespace detail {
 
+void
+throw_bad_alloc(
+    source_location const& loc)
+{
+    throw_exception(std::bad_alloc(), loc);
+}
+
 void
 throw_bad_typeid(
     source_location const& loc)
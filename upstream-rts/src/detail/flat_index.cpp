@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/detail/flat_index.hpp>
+#include <boost/assert.hpp>
+#include <utility>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+flat_index::
+~flat_index()
+{
+    release();
+}
+
+flat_index::
+flat_index(
+    flat_index&& other) noexcept
+    : mr_(other.mr_)
+    , v_(other.v_)
+    , n_(other.n_)
+    , cap_(other.cap_)
+{
+    other.v_ = nullptr;
+    other.n_ = 0;
+    other.cap_ = 0;
+}
+
+void
+flat_index::
+swap(flat_index& other) noexcept
+{
+    std::swap(mr_, other.mr_);
+    std::swap(v_, other.v_);
+    std::swap(n_, other.n_);
+    std::swap(cap_, other.cap_);
+}
+
+bool
+flat_index::
+insert(
+    core::typeinfo const& ti,
+    std::size_t hash,
+    std::size_t slot,
+    void* p,
+    void const* owner)
+{
+    if(find_entry(ti, hash))
+        return false;
+    // keep the load factor at or below one half
+    if(2 * (n_ + 1) > cap_)
+        rehash(cap_ ? 2 * cap_ : 16);
+    auto const mask = cap_ - 1;
+    auto i = hash & mask;
+    while(v_[i].ti)
+        i = (i + 1) & mask;
+    v_[i] = { hash, &ti, slot, p, owner };
+    ++n_;
+    return true;
+}
+
+void
+flat_index::
+reserve(std::size_t n)
+{
+    // keep the load factor at or below one half
+    if(2 * n <= cap_)
+        return;
+    std::size_t cap = cap_ ? cap_ : 16;
+    while(cap < 2 * n)
+        cap *= 2;
+    rehash(cap);
+}
+
+void
+flat_index::
+erase(
+    core::typeinfo const& ti,
+    std::size_t hash) noexcept
+{
+    if(n_ == 0)
+        return;
+    auto const mask = cap_ - 1;
+    auto i = hash & mask;
+    for(;; i = (i + 1) & mask)
+    {
+        auto const& e = v_[i];
+        if(! e.ti)
+            return;
+        if( e.hash == hash && (
+                e.ti == &ti || *e.ti == ti))
+            break;
+    }
+    // backward-shift the rest of the cluster
+    auto j = i;
+    for(;;)
+    {
+        j = (j + 1) & mask;
+        if(! v_[j].ti)
+            break;
+        auto const home = v_[j].hash & mask;
+        // move v_[j] into the hole at i unless
+        // its home lies cyclically within (i, j]
+        if(((j - home) & mask) >= ((j - i) & mask))
+        {
+            v_[i] = v_[j];
+            i = j;
+        }
+    }
+    v_[i] = entry();
+    --n_;
+}
+
+void
+flat_index::
+erase_within(
+    void const* first,
+    std::size_t n) noexcept
+{
+    // erasing shifts later entries back into slot i,
+    // so it is examined again before moving on
+    for(std::size_t i = 0; i < cap_;)
+    {
+        auto const& e = v_[i];
+        if(e.ti && within(e.p, first, n))
+            erase(*e.ti, e.hash);
+        else
+            ++i;
+    }
+}
+
+void
+flat_index::
+relocate(
+    void const* first,
+    std::size_t n,
+    void* to) noexcept
+{
+    for(std::size_t i = 0; i < cap_; ++i)
+    {
+        auto& e = v_[i];
+        if(e.ti && within(e.p, first, n))
+            e.p = static_cast<char*>(to) + (
+                static_cast<char*>(e.p) -
+                static_cast<char const*>(first));
+    }
+}
+
+void
+flat_index::
+clear() noexcept
+{
+    release();
+    v_ = nullptr;
+    n_ = 0;
+    cap_ = 0;
+}
+
+void
+flat_index::
+reset() noexcept
+{
+    for(std::size_t i = 0; i < cap_; ++i)
+        v_[i] = entry();
+    n_ = 0;
+}
+
+void
+flat_index::
+rehash(std::size_t cap)
+{
+    BOOST_ASSERT((cap & (cap - 1)) == 0);
+    BOOST_ASSERT(2 * n_ <= cap);
+    auto const v = static_cast<entry*>(detail::allocate(
+        mr_, cap * sizeof(entry), alignof(entry)));
+    for(std::size_t k = 0; k < cap; ++k)
+        v[k] = entry();
+    auto const mask = cap - 1;
+    for(std::size_t k = 0; k < cap_; ++k)
+    {
+        auto const& e = v_[k];
+        if(! e.ti)
+            continue;
+        auto i = e.hash & mask;
+        while(v[i].ti)
+            i = (i + 1) & mask;
+        v[i] = e;
+    }
+    release();
+    v_ = v;
+    cap_ = cap;
+}
+
+void
+flat_index::
+release() noexcept
+{
+    if(v_)
+        detail::deallocate(mr_, v_,
+            cap_ * sizeof(entry), alignof(entry));
+}
+
+} // detail
+} // rts
+} // boost
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/detail/lookup_stats.hpp>
+#include <chrono>
+#include <new>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+std::uint64_t
+now_ns() noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<
+            std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().
+                    time_since_epoch()).count());
+}
+
+lookup_stats::
+~lookup_stats()
+{
+    for(auto& c : c_)
+        delete[] c.load(std::memory_order_relaxed);
+}
+
+void
+lookup_stats::
+swap(lookup_stats& other) noexcept
+{
+    for(std::size_t k = 0; k < max_chunks; ++k)
+        other.c_[k].store(c_[k].exchange(
+            other.c_[k].load(std::memory_order_relaxed),
+                std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+}
+
+void
+lookup_stats::
+reset() noexcept
+{
+    for(std::size_t k = 0; k < max_chunks; ++k)
+    {
+        auto const c = c_[k].load(
+            std::memory_order_acquire);
+        if(! c)
+            continue;
+        for(std::size_t i = 0,
+            n = std::size_t(1) << k; i < n; ++i)
+        {
+            for(auto& v : c[i].hits)
+                v.store(0, std::memory_order_relaxed);
+            for(auto& v : c[i].misses)
+                v.store(0, std::memory_order_relaxed);
+            for(auto& v : c[i].count)
+                v.store(0, std::memory_order_relaxed);
+            for(auto& v : c[i].ns)
+                v.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+key_counters*
+lookup_stats::
+make(std::size_t k) const noexcept
+{
+    // value-initialized, so every counter is zero
+    auto c = new(std::nothrow) key_counters[
+        std::size_t(1) << k]();
+    if(! c)
+        return nullptr;
+    key_counters* expected = nullptr;
+    if(c_[k].compare_exchange_strong(
+            expected, c,
+            std::memory_order_acq_rel,
+            std::memory_order_acquire))
+        return c;
+    // another thread made it first
+    delete[] c;
+    return expected;
+}
+
+} // detail
+} // rts
+} // boost
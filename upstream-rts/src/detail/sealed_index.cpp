@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/detail/sealed_index.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+sealed_index::
+~sealed_index()
+{
+    clear();
+}
+
+void
+sealed_index::
+swap(sealed_index& other) noexcept
+{
+    std::swap(mr_, other.mr_);
+    std::swap(v_, other.v_);
+    std::swap(disp_, other.disp_);
+    std::swap(mbits_, other.mbits_);
+    std::swap(rbits_, other.rbits_);
+}
+
+bool
+sealed_index::
+build(flat_index const& src)
+{
+    std::vector<entry> keys;
+    keys.reserve(src.size());
+    for(std::size_t i = 0; i < src.capacity(); ++i)
+        if(src.data()[i].ti)
+            keys.push_back(src.data()[i]);
+    if(keys.empty())
+    {
+        clear();
+        return true;
+    }
+
+    // about two keys per bucket, at most
+    // one key per two slots, at least two of each
+    unsigned rbits = 1;
+    while((std::size_t(1) << rbits) * 2 < keys.size())
+        ++rbits;
+    unsigned mbits = 1;
+    while((std::size_t(1) << mbits) < 2 * keys.size())
+        ++mbits;
+    unsigned const max_mbits = mbits + 4;
+
+    std::vector<std::vector<std::size_t>> buckets;
+    std::vector<std::size_t> order;
+    std::vector<bool> used;
+    std::vector<std::uint32_t> disp;
+    for(;;)
+    {
+        std::size_t const r = std::size_t(1) << rbits;
+        std::size_t const m = std::size_t(1) << mbits;
+        buckets.assign(r, {});
+        for(std::size_t i = 0; i < keys.size(); ++i)
+            buckets[bucket(keys[i].hash, rbits)].push_back(i);
+        order.resize(r);
+        for(std::size_t b = 0; b < r; ++b)
+            order[b] = b;
+        // place the largest buckets first
+        std::stable_sort(order.begin(), order.end(),
+            [&](std::size_t a, std::size_t b)
+            {
+                return buckets[a].size() > buckets[b].size();
+            });
+        used.assign(m, false);
+        disp.assign(r, 0);
+
+        bool ok = true;
+        for(auto const b : order)
+        {
+            auto const& bk = buckets[b];
+            if(bk.empty())
+                break;
+            std::uint32_t d = 0;
+            for(; d < 4096; ++d)
+            {
+                bool fits = true;
+                for(std::size_t j = 0; fits && j < bk.size(); ++j)
+                {
+                    auto const s = slot(keys[bk[j]].hash, d, mbits);
+                    if(used[s])
+                        fits = false;
+                    // distinct within the bucket
+                    for(std::size_t k = 0; fits && k < j; ++k)
+                        if(slot(keys[bk[k]].hash, d, mbits) == s)
+                            fits = false;
+                }
+                if(fits)
+                    break;
+            }
+            if(d == 4096)
+            {
+                ok = false;
+                break;
+            }
+            disp[b] = d;
+            for(auto const i : bk)
+                used[slot(keys[i].hash, d, mbits)] = true;
+        }
+        if(ok)
+            break;
+        // identical hashes can never be separated
+        if(mbits == max_mbits)
+            return false;
+        ++mbits;
+    }
+
+    // both tables share one block from the memory
+    // resource, the scratch space above is on the heap
+    std::size_t const m = std::size_t(1) << mbits;
+    auto const v = static_cast<entry*>(detail::allocate(
+        mr_, bytes(mbits, rbits), alignof(entry)));
+    for(std::size_t i = 0; i < m; ++i)
+        v[i] = entry();
+    for(auto const& e : keys)
+        v[slot(e.hash, disp[bucket(e.hash, rbits)], mbits)] = e;
+    auto const dv = reinterpret_cast<std::uint32_t*>(v + m);
+    std::copy(disp.begin(), disp.end(), dv);
+
+    clear();
+    v_ = v;
+    disp_ = dv;
+    mbits_ = mbits;
+    rbits_ = rbits;
+    return true;
+}
+
+void
+sealed_index::
+relocate(
+    void const* first,
+    std::size_t n,
+    void* to) noexcept
+{
+    if(! v_)
+        return;
+    for(std::size_t i = 0; i < (std::size_t(1) << mbits_); ++i)
+    {
+        auto& e = v_[i];
+        if(e.ti && within(e.p, first, n))
+            e.p = static_cast<char*>(to) + (
+                static_cast<char*>(e.p) -
+                static_cast<char const*>(first));
+    }
+}
+
+void
+sealed_index::
+clear() noexcept
+{
+    if(v_)
+        detail::deallocate(mr_, v_,
+            bytes(mbits_, rbits_), alignof(entry));
+    v_ = nullptr;
+    disp_ = nullptr;
+    mbits_ = 0;
+    rbits_ = 0;
+}
+
+} // detail
+} // rts
+} // boost
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/detail/type_slot.hpp>
+#include <boost/rts/polystore.hpp>
+#include <mutex>
+#include <unordered_map>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+namespace {
+
+struct hasher
+{
+    std::size_t operator()(
+        typeindex const& t) const noexcept
+    {
+        return t.hash_code();
+    }
+};
+
+struct registry
+{
+    std::mutex m;
+    std::unordered_map<
+        typeindex, std::size_t, hasher> ids;
+};
+
+registry&
+get_registry()
+{
+    static registry r;
+    return r;
+}
+
+} // (anon)
+
+std::size_t
+make_type_slot(core::typeinfo const& ti)
+{
+    auto& r = get_registry();
+    std::lock_guard<std::mutex> lock(r.m);
+    return r.ids.emplace(typeindex(ti),
+        r.ids.size()).first->second;
+}
+
+} // detail
+} // rts
+} // boost
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/error.hpp>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+const char*
+error_cat_type::
+name() const noexcept
+{
+    return "boost.rts";
+}
+
+std::string
+error_cat_type::
+message(int ev) const
+{
+    return message(ev, nullptr, 0);
+}
+
+char const*
+error_cat_type::
+message(
+    int ev,
+    char*,
+    std::size_t) const noexcept
+{
+    switch(static_cast<error>(ev))
+    {
+    case error::not_found: return "object not found";
+    case error::duplicate_key: return "duplicate key";
+    case error::sealed: return "container is sealed";
+    default:
+        return "unknown";
+    }
+}
+
+// msvc 14.0 has a bug that warns about inability
+// to use constexpr construction here, even though
+// there's no constexpr construction
+#if defined(_MSC_VER) && _MSC_VER <= 1900
+# pragma warning( push )
+# pragma warning( disable : 4592 )
+#endif
+
+#if defined(__cpp_constinit) && __cpp_constinit >= 201907L
+constinit error_cat_type error_cat;
+#else
+error_cat_type error_cat;
+#endif
+
+#if defined(_MSC_VER) && _MSC_VER <= 1900
+# pragma warning( pop )
+#endif
+
+} // detail
+} // rts
+} // boost
@@ -0,0 +1,299 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/per_thread.hpp>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace boost {
+namespace rts {
+namespace detail {
+
+/*  An instance, shared by its thread and its container
+
+    The node is linked into the list of its container
+    while both are alive. Whichever of the two ends first
+    unlinks it under the registry mutex, and then stops
+    and destroys the instance. The node itself is freed
+    when both have let go of it.
+*/
+struct per_thread_node
+{
+    per_thread_base* owner;
+    void* p;
+    void (*destroy)(void*) noexcept;
+    per_thread_node* prev = nullptr;
+    per_thread_node* next = nullptr;
+    int refs = 2;
+
+    per_thread_node(
+        per_thread_base& owner_,
+        void* p_) noexcept
+        : owner(&owner_)
+        , p(p_)
+        , destroy(owner_.ops_->destroy)
+    {
+    }
+
+    // called with the mutex held
+    void
+    unlink() noexcept
+    {
+        if(prev)
+            prev->next = next;
+        else
+            owner->head_ = next;
+        if(next)
+            next->prev = prev;
+        owner = nullptr;
+    }
+};
+
+namespace {
+
+struct registry
+{
+    std::mutex m;
+    std::vector<std::size_t> free_ids;
+    std::size_t next_id = 0;
+    std::uint64_t next_serial = 1;
+};
+
+registry&
+get_registry()
+{
+    static registry r;
+    return r;
+}
+
+// drops one reference, freeing the node with the last
+void
+release(per_thread_node* n) noexcept
+{
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(
+            get_registry().m);
+        last = --n->refs == 0;
+    }
+    if(last)
+        delete n;
+}
+
+// the table of a thread, which cleans up when it exits
+struct thread_table : per_thread_table
+{
+    thread_table() noexcept
+        : per_thread_table{ nullptr, 0 }
+    {
+    }
+
+    ~thread_table()
+    {
+        // instances may use other containers
+        // while being destroyed, which appends
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            auto const nd = v[i].n;
+            if(! nd)
+                continue;
+            v[i] = per_thread_slot{ 0, nullptr, nullptr };
+            bool mine = false;
+            {
+                std::lock_guard<std::mutex> lock(
+                    get_registry().m);
+                if(nd->owner)
+                {
+                    // the container won't see it again
+                    nd->unlink();
+                    nd->refs -= 1;
+                    mine = true;
+                }
+            }
+            if(mine)
+                nd->destroy(nd->p);
+            release(nd);
+        }
+        ::operator delete(v);
+        v = nullptr;
+        n = 0;
+    }
+
+    void
+    grow(std::size_t id)
+    {
+        if(id < n)
+            return;
+        std::size_t n1 = n > 0 ? 2 * n : 8;
+        while(n1 <= id)
+            n1 *= 2;
+        auto const v1 = static_cast<per_thread_slot*>(
+            ::operator new(n1 * sizeof(per_thread_slot)));
+        if(n > 0)
+            std::memcpy(v1, v, n * sizeof(per_thread_slot));
+        for(auto i = n; i < n1; ++i)
+            v1[i] = per_thread_slot{ 0, nullptr, nullptr };
+        ::operator delete(v);
+        v = v1;
+        n = n1;
+    }
+};
+
+thread_table&
+get_table() noexcept
+{
+    static thread_local thread_table t;
+    return t;
+}
+
+} // (anon)
+
+per_thread_table const&
+local_table() noexcept
+{
+    return get_table();
+}
+
+per_thread_base::
+~per_thread_base()
+{
+    per_thread_node* head;
+    {
+        auto& r = get_registry();
+        std::lock_guard<std::mutex> lock(r.m);
+        head = head_;
+        for(auto n = head; n; n = n->next)
+            n->owner = nullptr;
+        head_ = nullptr;
+        r.free_ids.push_back(id_);
+    }
+    // the threads won't touch these instances now
+    while(head)
+    {
+        auto const next = head->next;
+        head->destroy(head->p);
+        release(head);
+        head = next;
+    }
+    ops_->free(args_);
+}
+
+per_thread_base::
+per_thread_base(
+    void* args,
+    per_thread_ops const& ops)
+    : args_(args)
+    , ops_(&ops)
+{
+    struct do_construct
+    {
+        per_thread_base& self;
+        bool ok = false;
+
+        explicit
+        do_construct(per_thread_base& self_) noexcept
+            : self(self_)
+        {
+        }
+
+        ~do_construct()
+        {
+            if(! ok)
+                self.ops_->free(self.args_);
+        }
+
+        void apply()
+        {
+            auto& r = get_registry();
+            std::lock_guard<std::mutex> lock(r.m);
+            // reserve first, so the destructor can't throw
+            r.free_ids.reserve(r.next_id + 1);
+            if(r.free_ids.empty())
+            {
+                self.id_ = r.next_id++;
+            }
+            else
+            {
+                self.id_ = r.free_ids.back();
+                r.free_ids.pop_back();
+            }
+            self.serial_ = r.next_serial++;
+            ok = true;
+        }
+    };
+
+    do_construct(*this).apply();
+}
+
+void*
+per_thread_base::
+make_local()
+{
+    auto& t = get_table();
+    t.grow(id_);
+    if(auto const n = t.v[id_].n)
+    {
+        // left over from an earlier container
+        t.v[id_] = per_thread_slot{ 0, nullptr, nullptr };
+        release(n);
+    }
+
+    struct do_make
+    {
+        per_thread_base& self;
+        void* p;
+
+        ~do_make()
+        {
+            if(p)
+                self.ops_->destroy(p);
+        }
+
+        per_thread_node*
+        apply()
+        {
+            auto const n = new per_thread_node(self, p);
+            {
+                std::lock_guard<std::mutex> lock(
+                    get_registry().m);
+                n->next = self.head_;
+                if(n->next)
+                    n->next->prev = n;
+                self.head_ = n;
+            }
+            p = nullptr;
+            return n;
+        }
+    };
+
+    // the constructor may use other containers,
+    // which can reallocate the table
+    auto const p = ops_->make(args_);
+    auto const n = do_make{ *this, p }.apply();
+    t.v[id_] = per_thread_slot{ serial_, p, n };
+    return p;
+}
+
+std::size_t
+per_thread_base::
+count() const noexcept
+{
+    std::lock_guard<std::mutex> lock(
+        get_registry().m);
+    std::size_t n = 0;
+    for(auto p = head_; p; p = p->next)
+        ++n;
+    return n;
+}
+
+} // detail
+} // rts
+} // boost
@@ -8,12 +8,30 @@
 //
 
 #include <boost/rts/polystore.hpp>
+#include <algorithm>
+#include <functional>
 #include <utility>
 
 namespace boost {
 namespace rts {
 
-polystore::any::~any() = default;
+namespace {
+
+// ensure push_back can't fail, keeping room for
+// the elements of factory objects not made yet,
+// and growing geometrically as push_back would
+template<class Vector>
+void
+grow(Vector& v, std::size_t pending)
+{
+    auto const n = v.size() + pending;
+    if(n < v.capacity())
+        return;
+    v.reserve((std::max)(n + 1,
+        v.empty() ? 8 : 2 * v.size()));
+}
+
+} // (anon)
 
 polystore::
 ~polystore()
@@ -21,13 +39,50 @@ polystore::
     destroy();
 }
 
+polystore::
+polystore(
+    container::pmr::memory_resource* mr) noexcept
+    : a_(mr)
+    , v_(detail::allocator<any>(mr))
+    , h_(detail::allocator<any>(mr))
+    , m_(mr)
+    , s_(mr)
+    , ls_(mr)
+    , ph_(mr)
+{
+}
+
+polystore::
+polystore(
+    polystore const* parent,
+    container::pmr::memory_resource* mr) noexcept
+    : polystore(mr)
+{
+    parent_ = parent;
+}
+
 polystore::
 polystore(
     polystore&& other) noexcept
+    : polystore(other.resource())
 {
     using std::swap;
+    a_.swap(other.a_);
     swap(v_, other.v_);
-    swap(m_, other.m_);
+    swap(h_, other.h_);
+    m_.swap(other.m_);
+    s_.swap(other.s_);
+    ls_.swap(other.ls_);
+    ph_.swap(other.ph_);
+    swap(lazy_, other.lazy_);
+    swap(lazy_v_, other.lazy_v_);
+    swap(lazy_h_, other.lazy_h_);
+    swap(parent_, other.parent_);
+    swap(sealed_, other.sealed_);
+#ifdef BOOST_RTS_POLYSTORE_STATS
+    st_.swap(other.st_);
+#endif
+    ++other.gen_;
 }
 
 polystore&
@@ -38,11 +93,25 @@ operator=(
     if(this != &other)
     {
         using std::swap;
+        // tmp takes and destroys our old contents
         polystore tmp(std::move(*this));
-        swap(v_, tmp.v_);
-        swap(m_, tmp.m_);
+        a_.swap(other.a_);
         swap(v_, other.v_);
-        swap(m_, other.m_);
+        swap(h_, other.h_);
+        m_.swap(other.m_);
+        s_.swap(other.s_);
+        ls_.swap(other.ls_);
+        ph_.swap(other.ph_);
+        swap(lazy_, other.lazy_);
+        swap(lazy_v_, other.lazy_v_);
+        swap(lazy_h_, other.lazy_h_);
+        swap(parent_, other.parent_);
+        swap(sealed_, other.sealed_);
+#ifdef BOOST_RTS_POLYSTORE_STATS
+        st_.swap(other.st_);
+#endif
+        ++gen_;
+        ++other.gen_;
     }
     return *this;
 }
@@ -53,30 +122,221 @@ clear() noexcept
 {
     destroy();
     m_.clear();
+    s_.clear();
+    ls_.clear();
+    a_.clear();
+    ph_.clear();
+    sealed_ = false;
+    ++gen_;
+}
+
+void
+polystore::
+reset() noexcept
+{
+    destroy();
+    m_.reset();
+    s_.reset();
+    ls_.reset();
+    a_.reset();
+    ph_.clear();
+    sealed_ = false;
+    ++gen_;
 }
 
+void
+polystore::
+reserve(
+    std::size_t objects,
+    std::size_t keys)
+{
+    // not every object uses v_, so this may
+    // reserve more than needed. Few objects have
+    // hooks, so h_ is left to grow on demand, and
+    // s_ is sized by slots which aren't known here.
+    v_.reserve(objects);
+    m_.reserve(keys);
+}
+
+void
+polystore::
+reserve_all(
+    std::size_t destroys,
+    std::size_t hooks,
+    std::size_t keys,
+    std::size_t max_slot,
+    std::size_t bytes)
+{
+    // every object has at least one key
+    if(keys == 0)
+        return;
+    // keeping the room of unmade factory objects
+    if(destroys > 0)
+        v_.reserve(v_.size() + lazy_v_ + destroys);
+    if(hooks > 0)
+        h_.reserve(h_.size() + lazy_h_ + hooks);
+    m_.reserve(m_.size() + keys);
+    s_.reserve(max_slot, keys);
+    a_.reserve(bytes);
+}
+
+void
+polystore::
+seal()
+{
+    if(sealed_)
+        return;
+    // if no perfect hash exists, the
+    // flat index keeps serving lookups
+    ph_.build(m_);
+    sealed_ = true;
+}
+
+#ifdef BOOST_RTS_POLYSTORE_STATS
+
 auto
 polystore::
-get_elements() noexcept ->
-    elements
+stats() const ->
+    statistics
 {
-    return elements(v_.size(), *this);
+    statistics r;
+    for(std::size_t k = 0;
+        k < detail::lookup_stats::max_chunks; ++k)
+    {
+        std::size_t n;
+        auto const c = st_.chunk(k, n);
+        if(! c)
+            continue;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            auto const& e = c[i];
+            // a type is set before its first count
+            auto const ti = e.ti.load(
+                std::memory_order_acquire);
+            if(! ti)
+                continue;
+            auto const get = [](std::atomic<
+                std::uint64_t> const& v) noexcept
+                {
+                    return v.load(std::memory_order_relaxed);
+                };
+            key_statistics ks{
+                ti,
+                get(e.hits[0]), get(e.misses[0]),
+                get(e.hits[1]), get(e.misses[1]),
+                get(e.hits[2]), get(e.misses[2]),
+                get(e.count[0]), get(e.ns[0]),
+                get(e.count[1]), get(e.ns[1]) };
+            r.v_.push_back(ks);
+        }
+    }
+    return r;
 }
 
 void
 polystore::
-destroy() noexcept
+reset_stats() noexcept
 {
-    // destroy in reverse order
-    for(auto n = v_.size(); n--;)
-        v_.resize(n);
+    st_.reset();
 }
 
+#endif
+
 auto
 polystore::
-get(std::size_t i) -> any&
+get_memory_report() const ->
+    memory_report
 {
-    return *v_[i];
+    // objects can be in more than one of the
+    // lists, so collect them and remove duplicates
+    std::vector<any> v;
+    auto const* const e = m_.data();
+    for(std::size_t i = 0; i < m_.capacity(); ++i)
+        // only the key of an object's own type
+        // has both the object and its ops
+        if(e[i].ti && e[i].p && e[i].owner)
+            v.push_back(any(e[i].p,
+                *static_cast<ops const*>(e[i].owner)));
+    v.insert(v.end(), v_.begin(), v_.end());
+    v.insert(v.end(), h_.begin(), h_.end());
+    for(auto l = lazy_; l; l = l->next)
+        if(auto const p = l->p.load(
+                std::memory_order_acquire))
+            v.push_back(any(p, *l->o));
+    auto const less = [](any const& a, any const& b)
+        {
+            return std::less<void*>()(a.p_, b.p_);
+        };
+    std::sort(v.begin(), v.end(), less);
+    v.erase(std::unique(v.begin(), v.end(),
+        [](any const& a, any const& b)
+        {
+            return a.p_ == b.p_;
+        }), v.end());
+
+    memory_report r;
+    r.v_.reserve(v.size());
+    for(auto const& a : v)
+    {
+        auto const& o = *a.o_;
+        object_memory om{ o.type, o.size,
+            o.memory_usage ? o.memory_usage(a.p_) : 0 };
+        r.objects_ += om.size;
+        r.owned_ += om.owned;
+        r.v_.push_back(om);
+    }
+    r.storage_ = a_.allocated();
+    r.index_ =
+        m_.capacity() * sizeof(detail::flat_index::entry) +
+        ph_.allocated() +
+        s_.allocated() +
+        ls_.allocated() +
+        (v_.capacity() + h_.capacity()) * sizeof(any);
+    return r;
+}
+
+auto
+polystore::
+get_elements() noexcept ->
+    elements
+{
+    return elements(v_.size(), v_);
+}
+
+auto
+polystore::
+get_hooks() noexcept ->
+    elements
+{
+    return elements(h_.size(), h_);
+}
+
+void
+polystore::
+destroy() noexcept
+{
+    h_.clear();
+
+    // destroy in reverse order, including
+    // the objects made by factories
+    while(! v_.empty())
+    {
+        auto const e = v_.back();
+        v_.pop_back();
+        if(e.o_->destroy)
+            e.o_->destroy(e.p_);
+    }
+
+    // then the factories, which own the
+    // storage of the objects they made
+    while(lazy_)
+    {
+        auto const next = lazy_->next;
+        lazy_->destroy(*lazy_);
+        lazy_ = next;
+    }
+    lazy_v_ = 0;
+    lazy_h_ = 0;
 }
 
 void*
@@ -84,10 +344,137 @@ polystore::
 find(
     core::typeinfo const& ti) const noexcept
 {
-    auto const it = m_.find(ti);
-    if(it == m_.end())
-        return nullptr;
-    return it->second;
+    auto const h = hash(ti);
+    for(auto ps = this; ps; ps = ps->parent_)
+    {
+        auto const e = ps->ph_.empty() ?
+            ps->m_.find_entry(ti, h) :
+            ps->ph_.find_entry(ti, h);
+        if(! e)
+            continue;
+        auto p = e->p;
+        if(! p)
+        {
+            // an object not made yet is not found
+            auto const& k = *static_cast<
+                lazy_key const*>(e->owner);
+            if(auto const q = k.l->p.load(
+                    std::memory_order_acquire))
+                p = k.cast(q);
+        }
+#ifdef BOOST_RTS_POLYSTORE_STATS
+        // the slot registry takes a lock, so the
+        // slot comes from the entry, and a miss
+        // without an entry is not counted
+        st_.count(e->slot, ti,
+            detail::lookup_kind::find, p != nullptr);
+#endif
+        return p;
+    }
+    return nullptr;
+}
+
+void*
+polystore::
+find_object(
+    core::typeinfo const& ti) const
+{
+    auto const e = m_.find_entry(ti, hash(ti));
+    if(! e)
+        detail::throw_bad_typeid();
+    if(! e->owner)
+        detail::throw_invalid_argument(
+            "polystore: not an object type");
+    if(! e->p)
+        detail::throw_invalid_argument(
+            "polystore: object has a factory");
+    return e->p;
+}
+
+bool
+polystore::
+has_any(
+    core::typeinfo const* const* ti,
+    std::size_t n) const noexcept
+{
+    for(std::size_t i = 0; i < n; ++i)
+        if(m_.find_entry(*ti[i], hash(*ti[i])))
+            return true;
+    return false;
+}
+
+bool
+polystore::
+erase_impl(
+    core::typeinfo const& ti)
+{
+    auto const e = m_.find_entry(ti, hash(ti));
+    if(! e)
+        return false;
+    if(! e->owner)
+        detail::throw_invalid_argument(
+            "polystore: not an object type");
+    if(! e->p)
+        detail::throw_invalid_argument(
+            "polystore: object has a factory");
+    if(sealed_)
+        detail::throw_logic_error(
+            "polystore: sealed");
+
+    auto const p = e->p;
+    auto const o = static_cast<ops const*>(e->owner);
+    // every key points into the object
+    m_.erase_within(p, o->size);
+    s_.erase_if([p, o](void* q)
+        {
+            return detail::within(q, p, o->size);
+        });
+    auto const match = [p](any const& a)
+        {
+            return a.p_ == p;
+        };
+    auto const it = std::find_if(
+        v_.begin(), v_.end(), match);
+    if(it != v_.end())
+        v_.erase(it);
+    auto const ih = std::find_if(
+        h_.begin(), h_.end(), match);
+    if(ih != h_.end())
+        h_.erase(ih);
+    if(o->destroy)
+        o->destroy(p);
+    a_.deallocate(p, o->size);
+    ++gen_;
+    return true;
+}
+
+void
+polystore::
+relocate(
+    void* from,
+    any to) noexcept
+{
+    auto const n = to.o_->size;
+    m_.relocate(from, n, to.p_);
+    ph_.relocate(from, n, to.p_);
+    s_.update([from, n, &to](void* q) -> void*
+        {
+            if(! detail::within(q, from, n))
+                return q;
+            return static_cast<char*>(to.p_) + (
+                static_cast<char*>(q) -
+                static_cast<char*>(from));
+        });
+    for(auto& a : v_)
+        if(a.p_ == from)
+            a.p_ = to.p_;
+    for(auto& a : h_)
+        if(a.p_ == from)
+            a.p_ = to.p_;
+    if(to.o_->destroy)
+        to.o_->destroy(from);
+    a_.deallocate(from, n);
+    ++gen_;
 }
 
 void*
@@ -95,44 +482,197 @@ polystore::
 insert_impl(
     any_ptr p, key const* k, std::size_t n)
 {
-    struct do_insert
+    auto const pt = p.get();
+    auto const t = start_timer(
+        detail::timed_kind::insert);
+    auto const d = p.has_destroy();
+    auto const h = p.has_hooks();
+    if(d)
+        grow(v_, lazy_v_);
+    if(h)
+        grow(h_, lazy_h_);
+    // the first key is the object's own type
+    add_keys(k, n, p.get_ops());
+    auto const e = p.release();
+    if(d)
+        v_.push_back(e);
+    if(h)
+        h_.push_back(e);
+    ++gen_;
+    if(n > 0)
+        t.stop(k[0].slot, *k[0].ti);
+    return pt;
+}
+
+void
+polystore::
+register_impl(
+    lazy& l, lazy_key const* k, std::size_t n)
+{
+    struct do_register
     {
-        any_ptr p;
-        key const* k;
+        lazy& l;
+        lazy_key const* k;
         std::size_t n;
         polystore& ps;
         std::size_t i = 0;
 
-        do_insert(
-            any_ptr p_,
-            key const* k_,
+        do_register(
+            lazy& l_,
+            lazy_key const* k_,
             std::size_t n_,
             polystore& ps_)
-            : p(std::move(p_)), k(k_), n(n_), ps(ps_)
+            : l(l_), k(k_), n(n_), ps(ps_)
+        {
+        }
+
+        ~do_register()
         {
-            // ensure emplace_back can't fail
-            ps.v_.reserve(ps.v_.size() + 1);
+            if(i == n)
+                return;
+            while(i--)
+                ps.m_.erase(*k[i].ti,
+                    hash(*k[i].ti));
+            l.destroy(l);
+        }
+
+        void apply()
+        {
+            // room for the element of the object,
+            // which is appended when it is made
+            auto const d = l.o->destroy != nullptr;
+            auto const h = l.o->start || l.o->stop;
+            if(d)
+                grow(ps.v_, ps.lazy_v_);
+            if(h)
+                grow(ps.h_, ps.lazy_h_);
+
+            // ensure the slot table can take every key
+            ps.ls_.reserve(k, n);
 
             for(;i < n;++i)
-                if(! ps.m_.emplace(k[i].ti, k[i].p).second)
+                // no object yet, so the entry
+                // refers to the key instead
+                if(! ps.m_.insert(*k[i].ti,
+                        hash(*k[i].ti), k[i].slot,
+                        nullptr, &k[i]))
                     detail::throw_invalid_argument(
                         "polystore: duplicate key");
 
-            ps.v_.emplace_back(std::move(p));
+            for(std::size_t j = 0; j < n; ++j)
+                ps.ls_.set(k[j].slot, &k[j]);
+            if(d)
+                ++ps.lazy_v_;
+            if(h)
+                ++ps.lazy_h_;
+            l.next = ps.lazy_;
+            ps.lazy_ = &l;
+            ++ps.gen_;
         }
+    };
+
+    do_register(l, k, n, *this).apply();
+}
 
-        ~do_insert()
+void*
+polystore::
+make(lazy& l) const
+{
+    std::lock_guard<std::mutex> lock(l.m);
+    if(auto const p = l.p.load(
+            std::memory_order_relaxed))
+        return p;
+    auto const p = l.make(l, *this);
+    {
+        // the object takes its place in the order
+        // of construction. Room was reserved when
+        // the factory was registered, so this
+        // can't fail.
+        std::lock_guard<std::mutex> lock(lm_);
+        if(l.o->destroy)
+        {
+            v_.push_back(any(p, *l.o));
+            --lazy_v_;
+        }
+        if(l.o->start || l.o->stop)
+        {
+            h_.push_back(any(p, *l.o));
+            --lazy_h_;
+        }
+    }
+    l.p.store(p, std::memory_order_release);
+    return p;
+}
+
+// the keys of an object owned elsewhere, which
+// is neither destroyed nor erased by the container
+void
+polystore::
+insert_keys(
+    key const* k, std::size_t n)
+{
+    if(sealed_)
+        detail::throw_logic_error(
+            "polystore: sealed");
+    auto const t = start_timer(
+        detail::timed_kind::insert);
+    add_keys(k, n, nullptr);
+    ++gen_;
+    if(n > 0)
+        t.stop(k[0].slot, *k[0].ti);
+}
+
+// inserts every key or none, and only the
+// first key is given the owner
+void
+polystore::
+add_keys(
+    key const* k,
+    std::size_t n,
+    void const* owner)
+{
+    struct do_add
+    {
+        key const* k;
+        std::size_t n;
+        polystore& ps;
+        std::size_t i = 0;
+
+        do_add(
+            key const* k_,
+            std::size_t n_,
+            polystore& ps_)
+            : k(k_), n(n_), ps(ps_)
+        {
+        }
+
+        ~do_add()
         {
             if(i == n)
                 return;
             while(i--)
-                ps.m_.erase(k[i].ti);
+                ps.m_.erase(*k[i].ti,
+                    hash(*k[i].ti));
+        }
+
+        void apply(void const* owner)
+        {
+            // ensure the slot table can take every key
+            ps.s_.reserve(k, n);
+
+            for(;i < n;++i)
+                if(! ps.m_.insert(*k[i].ti,
+                        hash(*k[i].ti), k[i].slot, k[i].p,
+                        i == 0 ? owner : nullptr))
+                    detail::throw_invalid_argument(
+                        "polystore: duplicate key");
+
+            for(std::size_t j = 0; j < n; ++j)
+                ps.s_.set(k[j].slot, k[j].p);
         }
     };
 
-    auto const pt = p->get();
-    do_insert(std::move(p), k, n, *this);
-    return pt;
+    do_add(k, n, *this).apply(owner);
 }
 
 } // rts
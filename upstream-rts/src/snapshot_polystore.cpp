@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+#include <boost/rts/snapshot_polystore.hpp>
+
+namespace boost {
+namespace rts {
+
+/*  cur_ is loaded and stored atomically, so a reader
+    always sees a complete snapshot, and the reference
+    it takes keeps the snapshot alive after a writer
+    replaces it.
+*/
+
+snapshot_polystore::
+~snapshot_polystore() = default;
+
+snapshot_polystore::
+snapshot_polystore()
+    : cur_(snapshot_ptr(new snapshot))
+{
+}
+
+auto
+snapshot_polystore::
+load() const noexcept ->
+    snapshot_ptr
+{
+    return cur_.load();
+}
+
+void
+snapshot_polystore::
+publish(editor& e)
+{
+    std::shared_ptr<snapshot> s(new snapshot);
+    std::size_t n = 0;
+    for(auto const& p : e.v_)
+        n += p->n;
+    s->ps_.reserve(0, n);
+    for(auto const& p : e.v_)
+        s->ps_.insert_keys(p->k, p->n);
+    s->ps_.seal();
+    s->v_ = std::move(e.v_);
+    cur_.store(std::move(s));
+}
+
+std::size_t
+snapshot_polystore::editor::
+index_of(
+    core::typeinfo const& ti) const noexcept
+{
+    std::size_t i = 0;
+    for(; i < v_.size(); ++i)
+        if(*v_[i]->k[0].ti == ti)
+            break;
+    return i;
+}
+
+} // rts
+} // boost
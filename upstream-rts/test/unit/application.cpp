@@ -10,17 +10,147 @@
 // Test that header file is self-contained.
 #include <boost/rts/application.hpp>
 
-#include "test_suite.hpp"
+#include "test_helpers.hpp"
+
+#include <stdexcept>
+#include <string>
 
 namespace boost {
 namespace rts {
 
 struct application_test
 {
+    template<int I>
+    struct part
+    {
+        std::string& log;
+        bool fail;
+
+        explicit
+        part(std::string& log_, bool fail_ = false)
+            : log(log_)
+            , fail(fail_)
+        {
+        }
+
+        void start()
+        {
+            if(fail)
+                throw std::runtime_error("part");
+            log += "+" + std::to_string(I);
+        }
+
+        void stop()
+        {
+            log += "-" + std::to_string(I);
+        }
+    };
+
+    struct plain
+    {
+    };
+
+    // has start but no stop
+    struct starter
+    {
+        std::string& log;
+
+        explicit
+        starter(std::string& log_)
+            : log(log_)
+        {
+        }
+
+        void start()
+        {
+            log += "+s";
+        }
+    };
+
+    void
+    testStartStop()
+    {
+        std::string log;
+        application app;
+        app.emplace<part<1>>(log);
+        app.emplace<plain>();
+        app.emplace<starter>(log);
+        app.emplace<part<2>>(log);
+        app.start();
+        BOOST_TEST_EQ(log, "+1+s+2");
+        BOOST_TEST(app.is_sealed());
+        BOOST_TEST_THROWS(app.emplace<part<3>>(log),
+            std::logic_error);
+        BOOST_TEST(app.find<part<3>>() == nullptr);
+        BOOST_TEST_NO_THROW(app.use<plain>());
+        BOOST_TEST_THROWS(app.start(),
+            std::invalid_argument);
+        app.stop();
+        BOOST_TEST_EQ(log, "+1+s+2-2-1");
+    }
+
+    void
+    testStartFailure()
+    {
+        std::string log;
+        application app;
+        app.emplace<part<1>>(log);
+        app.emplace<part<2>>(log);
+        app.emplace<part<3>>(log, true);
+        BOOST_TEST_THROWS(app.start(),
+            std::runtime_error);
+        BOOST_TEST_EQ(log, "+1+2-2-1");
+        BOOST_TEST(! app.is_sealed());
+    }
+
+    void
+    testFactory()
+    {
+        std::string log;
+        application app;
+        app.emplace<part<1>>(log);
+        app.register_factory<part<2>>([&log]
+            {
+                return part<2>(log);
+            });
+        app.register_factory<part<3>>([&log]
+            {
+                return part<3>(log);
+            });
+        app.emplace<part<4>>(log);
+        // made objects take their place when made
+        app.get<part<3>>();
+        app.start();
+        BOOST_TEST_EQ(log, "+1+4+3");
+        app.stop();
+        BOOST_TEST_EQ(log, "+1+4+3-3-4-1");
+    }
+
+    void
+    testResource()
+    {
+        counting_resource mr;
+        {
+            std::string log;
+            application app(&mr);
+            // the state of the application
+            BOOST_TEST_EQ(mr.calls.load(), 1u);
+            app.emplace<part<1>>(log);
+            app.start();
+            app.stop();
+            BOOST_TEST_EQ(log, "+1-1");
+        }
+        BOOST_TEST_EQ(mr.n.load(), 0u);
+    }
+
     void
     run()
     {
         application app;
+        testStartStop();
+        testStartFailure();
+        testFactory();
+        testResource();
     }
 };
 
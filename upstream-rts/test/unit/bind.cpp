@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+// Test that header file is self-contained.
+#include <boost/rts/bind.hpp>
+
+#include "test_suite.hpp"
+
+#include <typeinfo>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+struct A { int i = 1; };
+struct B { int i = 2; };
+struct C { int i = 3; };
+
+int sum(A& a, B const& b)
+{
+    return a.i + b.i;
+}
+
+} // (anon)
+
+struct bind_test
+{
+    void testBind()
+    {
+        polystore ps;
+        ps.emplace<A>();
+        ps.emplace<B>();
+
+        auto f = bind(ps, [](A& a, B const& b, C* c)
+            {
+                return a.i + b.i + (c ? c->i : 0);
+            });
+        BOOST_TEST_EQ(f(), 3);
+
+        // arguments are not looked up again
+        ps.get<A>().i = 10;
+        BOOST_TEST_EQ(f(), 12);
+        ps.emplace<C>();
+        BOOST_TEST_EQ(f(), 12);
+        f.rebind(ps);
+        BOOST_TEST_EQ(f(), 15);
+
+        // functions and mutable state
+        BOOST_TEST_EQ(bind(ps, &sum)(), 12);
+        int n = 0;
+        auto g = bind(ps, [n](C& c) mutable
+            {
+                return c.i + n++;
+            });
+        BOOST_TEST_EQ(g(), 3);
+        BOOST_TEST_EQ(g(), 4);
+    }
+
+    void testMissing()
+    {
+        polystore ps;
+        auto const f = [](A& a) { return a.i; };
+        BOOST_TEST_THROWS(bind(ps, f), std::bad_typeid);
+
+        // rebind has the strong guarantee
+        ps.emplace<A>();
+        auto g = bind(ps, [](A& a, B* b)
+            {
+                return a.i + (b ? b->i : 0);
+            });
+        polystore ps2;
+        ps2.emplace<B>();
+        BOOST_TEST_THROWS(g.rebind(ps2), std::bad_typeid);
+        BOOST_TEST_EQ(g(), 1);
+    }
+
+    void run()
+    {
+        testBind();
+        testMissing();
+    }
+};
+
+TEST_SUITE(
+    bind_test,
+    "boost.rts.bind");
+
+} // rts
+} // boost
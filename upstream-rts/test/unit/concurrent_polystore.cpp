@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+// Test that header file is self-contained.
+#include <boost/rts/concurrent_polystore.hpp>
+
+#include "test_suite.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+template<std::size_t I>
+struct item
+{
+    static std::atomic<int> count;
+
+    std::size_t i = I;
+
+    item() { ++count; }
+};
+
+template<std::size_t I>
+std::atomic<int> item<I>::count{ 0 };
+
+// Races every thread on try_emplace of item<0> through item<N-1>
+template<std::size_t N>
+struct items
+{
+    static bool use(concurrent_polystore& ps)
+    {
+        bool const ok = items<N - 1>::use(ps);
+        auto& t = ps.use<item<N - 1>>();
+        return ok && t.i == N - 1 &&
+            ps.find<item<N - 1>>() == &t;
+    }
+
+    static bool counted()
+    {
+        return items<N - 1>::counted() &&
+            item<N - 1>::count == 1;
+    }
+};
+
+template<>
+struct items<0>
+{
+    static bool use(concurrent_polystore&) { return true; }
+    static bool counted() { return true; }
+};
+
+template<std::size_t I>
+struct tag
+{
+};
+
+// Gives tag<0> through tag<N-1> their type slots
+template<std::size_t N>
+struct tags
+{
+    static void slot()
+    {
+        tags<N - 1>::slot();
+        (void)detail::type_slot<tag<N - 1>>();
+    }
+
+    static bool use(concurrent_polystore& ps)
+    {
+        bool const ok = tags<N - 1>::use(ps);
+        auto& t = ps.use<tag<N - 1>>();
+        return ok && ps.find<tag<N - 1>>() == &t;
+    }
+};
+
+template<>
+struct tags<0>
+{
+    static void slot() {}
+    static bool use(concurrent_polystore&) { return true; }
+};
+
+} // (anon)
+
+struct concurrent_polystore_test
+{
+    void testFind()
+    {
+        struct A { int i = 1; };
+        struct B { int i = 2; };
+        struct C : B { };
+        concurrent_polystore ps;
+        BOOST_TEST(ps.find<A>() == nullptr);
+        BOOST_TEST(ps.find(BOOST_CORE_TYPEID(A)) == nullptr);
+        BOOST_TEST_THROWS(ps.get<A>(), std::bad_typeid);
+        ps.emplace<A>();
+        ps.emplace<C, B>();
+        BOOST_TEST_EQ(ps.get<A>().i, 1);
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(A)),
+            static_cast<void*>(ps.find<A>()));
+        BOOST_TEST_EQ(ps.find<B>(), ps.find<C>());
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(B)),
+            static_cast<void*>(ps.find<B>()));
+        BOOST_TEST_THROWS(ps.emplace<A>(),
+            std::invalid_argument);
+        BOOST_TEST_EQ(&ps.try_emplace<A>(), ps.find<A>());
+        invoke(ps, [](A& a, B const* b)
+            {
+                BOOST_TEST_EQ(a.i, 1);
+                BOOST_TEST(b != nullptr);
+            });
+    }
+
+    void testNested()
+    {
+        struct inner {};
+        struct outer
+        {
+            inner& in;
+            explicit outer(concurrent_polystore& ps)
+                : in(ps.use<inner>())
+            {
+            }
+        };
+        concurrent_polystore ps;
+        auto& o = ps.emplace<outer>(ps);
+        BOOST_TEST_EQ(&o.in, ps.find<inner>());
+    }
+
+    void testHighSlot()
+    {
+        struct far {};
+        // far gets a slot above the slots of the tags
+        tags<128>::slot();
+        (void)detail::type_slot<far>();
+        concurrent_polystore ps;
+        auto& f = ps.emplace<far>();
+        BOOST_TEST_EQ(ps.find<far>(), &f);
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(far)),
+            static_cast<void*>(&f));
+        // enough keys for far to move into slot_table
+        BOOST_TEST(tags<128>::use(ps));
+        BOOST_TEST_EQ(ps.find<far>(), &f);
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(far)),
+            static_cast<void*>(&f));
+    }
+
+    void testRace()
+    {
+        concurrent_polystore ps;
+        std::atomic<bool> go{ false };
+        std::atomic<int> failed{ 0 };
+        std::vector<std::thread> v;
+        for(int i = 0; i < 8; ++i)
+            v.emplace_back([&]
+                {
+                    while(! go)
+                        std::this_thread::yield();
+                    if(! items<64>::use(ps))
+                        ++failed;
+                });
+        go = true;
+        for(auto& t : v)
+            t.join();
+        BOOST_TEST_EQ(failed, 0);
+        BOOST_TEST(items<64>::counted());
+    }
+
+    void run()
+    {
+        testFind();
+        testNested();
+        testHighSlot();
+        testRace();
+    }
+};
+
+TEST_SUITE(
+    concurrent_polystore_test,
+    "boost.rts.concurrent_polystore");
+
+} // rts
+} // boost
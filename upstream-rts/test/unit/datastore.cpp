@@ -10,14 +10,67 @@
 // Test that header file is self-contained.
 #include <boost/rts/datastore.hpp>
 
-#include "test_suite.hpp"
+#include "test_helpers.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace boost {
 namespace rts {
 
+namespace {
+
+struct request
+{
+    int& live;
+    std::string s;
+    char buf[1000];
+
+    explicit request(int& live_)
+        : live(live_)
+        , s(100, 'x')
+    {
+        ++live;
+    }
+
+    ~request()
+    {
+        --live;
+    }
+};
+
+struct user
+{
+    int id = 0;
+};
+
+struct session
+{
+    int n = 0;
+};
+
+// what each request puts in its datastore
+void
+fill(datastore& ds, int& live)
+{
+    ds.emplace<request>(live);
+    ds.emplace<user>().id = 1;
+    ds.register_factory<session>([]{ return session(); });
+    ds.get<session>();
+    for(int i = 0; i < 20; ++i)
+        ds.emplace_anon<user>();
+}
+
+} // (anon)
+
 struct datastore_test
 {
-    void run()
+    void testClear()
     {
         struct T{};
 
@@ -28,6 +81,196 @@ struct datastore_test
         ds.clear();
         BOOST_TEST_EQ( ds.find<T>(), nullptr );
     }
+
+    void testReset()
+    {
+        counting_resource mr;
+        int live = 0;
+        datastore ds(&mr);
+        fill(ds, live);
+        BOOST_TEST_EQ(live, 1);
+        polystore::handle<user> h(ds);
+        BOOST_TEST(h);
+        ds.reset();
+        BOOST_TEST_EQ(live, 0);
+        BOOST_TEST_EQ(ds.find<user>(), nullptr);
+        BOOST_TEST_EQ(ds.find(BOOST_CORE_TYPEID(session)), nullptr);
+        BOOST_TEST(! h);
+
+        // the same objects fit in the kept storage
+        auto const n = mr.calls.load();
+        for(int i = 0; i < 3; ++i)
+        {
+            fill(ds, live);
+            BOOST_TEST_EQ(ds.get<user>().id, 1);
+            ds.reset();
+        }
+        BOOST_TEST_EQ(mr.calls.load(), n);
+
+        // a sealed datastore can be filled again
+        fill(ds, live);
+        ds.seal();
+        ds.reset();
+        BOOST_TEST(! ds.is_sealed());
+        fill(ds, live);
+        ds.clear();
+        BOOST_TEST_EQ(live, 0);
+    }
+
+    void testPool()
+    {
+        struct A { int i = 1; };
+
+        polystore app;
+        app.emplace<A>();
+        counting_resource mr;
+        int live = 0;
+        {
+            datastore_pool pool(&app, 2, &mr);
+            BOOST_TEST_EQ(pool.size(), 0u);
+            {
+                auto ds = pool.acquire();
+                BOOST_TEST_EQ(ds->parent(), &app);
+                BOOST_TEST_EQ(ds->get<A>().i, 1);
+                fill(*ds, live);
+            }
+            BOOST_TEST_EQ(live, 0);
+            BOOST_TEST_EQ(pool.size(), 1u);
+
+            // steady state allocates nothing
+            auto const n = mr.calls.load();
+            for(int i = 0; i < 3; ++i)
+            {
+                auto ds = pool.acquire();
+                BOOST_TEST_EQ(pool.size(), 0u);
+                BOOST_TEST_EQ(ds->find<user>(), nullptr);
+                fill(*ds, live);
+            }
+            BOOST_TEST_EQ(mr.calls.load(), n);
+
+            // bounded
+            {
+                std::vector<datastore_pool::pointer> v;
+                for(int i = 0; i < 4; ++i)
+                    v.push_back(pool.acquire());
+            }
+            BOOST_TEST_EQ(pool.size(), 2u);
+
+            // returned on another thread
+            auto ds = pool.acquire();
+            fill(*ds, live);
+            std::size_t other = 99;
+            std::thread t([&]
+                {
+                    ds.reset();
+                    other = pool.size();
+                    auto ds2 = pool.acquire();
+                    fill(*ds2, live);
+                });
+            t.join();
+            BOOST_TEST_EQ(other, 0u);
+            BOOST_TEST_EQ(live, 0);
+            BOOST_TEST_EQ(pool.size(), 1u);
+        }
+        BOOST_TEST_EQ(live, 0);
+    }
+
+    void testResource()
+    {
+        struct T{};
+
+        // storage from a buffer on the stack
+        alignas(std::max_align_t) char buf[8192];
+        struct buffer_resource
+            : container::pmr::memory_resource
+        {
+            char* p;
+            char* end;
+
+            void* do_allocate(
+                std::size_t n, std::size_t align) override
+            {
+                auto const u = reinterpret_cast<std::uintptr_t>(p);
+                auto const q = p + ((align - (u & (align - 1))) & (align - 1));
+                if(n > static_cast<std::size_t>(end - q))
+                    throw std::bad_alloc();
+                p = q + n;
+                return q;
+            }
+
+            void do_deallocate(
+                void*, std::size_t, std::size_t) override
+            {
+            }
+
+            bool do_is_equal(memory_resource const& other)
+                const noexcept override
+            {
+                return this == &other;
+            }
+        } mr;
+        mr.p = buf;
+        mr.end = buf + sizeof(buf);
+        datastore ds2(&mr);
+        BOOST_TEST_EQ( ds2.resource(), &mr );
+        ds2.emplace<T>();
+        BOOST_TEST_NE( ds2.find<T>(), nullptr );
+        BOOST_TEST( mr.p != buf );
+    }
+
+    void testParent()
+    {
+        struct A { int i = 1; };
+        struct B { int i = 2; };
+        struct C { int i = 3; };
+
+        polystore app;
+        app.emplace<A>();
+        app.emplace<B>();
+        app.seal();
+        {
+            datastore ds(&app);
+            BOOST_TEST_EQ( ds.parent(), &app );
+            BOOST_TEST_EQ( ds.find<A>(), app.find<A>() );
+            BOOST_TEST_EQ( ds.find(BOOST_CORE_TYPEID(B)),
+                static_cast<void*>(app.find<B>()) );
+            BOOST_TEST_EQ( &ds.use<A>(), app.find<A>() );
+            BOOST_TEST_EQ( ds.find<C>(), nullptr );
+
+            // local objects shadow the parent
+            ds.emplace<B>().i = 20;
+            BOOST_TEST_EQ( ds.get<B>().i, 20 );
+            BOOST_TEST_EQ( app.get<B>().i, 2 );
+            BOOST_TEST_EQ( ds.find(BOOST_CORE_TYPEID(B)),
+                static_cast<void*>(ds.find<B>()) );
+
+            // nested scopes and invoke
+            datastore inner(&ds);
+            inner.emplace<C>();
+            BOOST_TEST_EQ( invoke(inner,
+                [](A& a, B& b, C& c)
+                {
+                    return a.i + b.i + c.i;
+                }), 24 );
+            BOOST_TEST_EQ( ds.find<C>(), nullptr );
+
+            // handles see changes in the parent
+            polystore::handle<C> h(ds);
+            BOOST_TEST( ! h );
+            ds.emplace<C>();
+            BOOST_TEST( h );
+        }
+        BOOST_TEST_EQ( app.get<B>().i, 2 );
+    }
+
+    void run()
+    {
+        testClear();
+        testReset();
+        testPool();
+        testResource();
+        testParent();
+    }
 };
 
 TEST_SUITE(datastore_test, "boost.rts.datastore");
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+// Test that header file is self-contained.
+#include <boost/rts/per_core.hpp>
+
+#include <boost/rts/application.hpp>
+#include <boost/rts/polystore.hpp>
+
+#include "test_suite.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+struct counter
+{
+    std::atomic<std::size_t> n;
+
+    explicit
+    counter(std::size_t n0 = 0)
+        : n(n0)
+    {
+    }
+};
+
+} // (anon)
+
+struct per_core_test
+{
+    void testReplicas()
+    {
+        per_core<counter> c(nullptr, 5u);
+        BOOST_TEST_EQ(c.size(), detail::core_count());
+        BOOST_TEST_GE(c.size(), 1u);
+        for(std::size_t i = 0; i < c.size(); ++i)
+        {
+            BOOST_TEST_EQ(c[i].n.load(), 5u);
+            // each replica has its own cache line
+            auto const u = reinterpret_cast<
+                std::uintptr_t>(&c[i]);
+            BOOST_TEST_EQ(u % detail::cache_line_size, 0u);
+            if(i > 0)
+                BOOST_TEST_GE(u - reinterpret_cast<
+                    std::uintptr_t>(&c[i - 1]),
+                        detail::cache_line_size);
+        }
+
+        // local is one of the replicas
+        auto const& cc = c;
+        auto const p = &cc.local();
+        BOOST_TEST(p >= &cc[0] && p <= &cc[c.size() - 1]);
+
+        // aggregate across threads
+        std::vector<std::thread> v;
+        for(int t = 0; t < 4; ++t)
+            v.emplace_back([&c]
+                {
+                    for(int i = 0; i < 1000; ++i)
+                        c.local().n.fetch_add(1,
+                            std::memory_order_relaxed);
+                });
+        for(auto& t : v)
+            t.join();
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < c.size(); ++i)
+            total += c[i].n.load();
+        BOOST_TEST_EQ(total, 5 * c.size() + 4000);
+    }
+
+    void testConstructFailure()
+    {
+        struct X
+        {
+            std::string s;
+
+            explicit X(int& n)
+                : s("replica")
+            {
+                if(--n == 0)
+                    throw std::runtime_error("");
+            }
+        };
+
+        // replicas already made are destroyed
+        int n = 1;
+        BOOST_TEST_THROWS(per_core<X>(nullptr, n),
+            std::runtime_error);
+        if(detail::core_count() > 1)
+        {
+            n = 2;
+            BOOST_TEST_THROWS(per_core<X>(nullptr, n),
+                std::runtime_error);
+        }
+        n = 0;
+        per_core<X> c(nullptr, n);
+        BOOST_TEST_EQ(c[0].s, "replica");
+    }
+
+    void testStartStop()
+    {
+        struct S
+        {
+            int n = 0;
+            void start() { ++n; }
+            void stop() { --n; }
+        };
+        struct P {};
+
+        BOOST_TEST(detail::has_start<per_core<S>>::value);
+        BOOST_TEST(detail::has_stop<per_core<S>>::value);
+        BOOST_TEST(! detail::has_start<per_core<P>>::value);
+        BOOST_TEST(! detail::has_stop<per_core<P>>::value);
+
+        application app;
+        auto& s = app.emplace_per_core<S>();
+        app.emplace_per_core<P>();
+        app.start();
+        for(std::size_t i = 0; i < s.size(); ++i)
+            BOOST_TEST_EQ(s[i].n, 1);
+        app.stop();
+        for(std::size_t i = 0; i < s.size(); ++i)
+            BOOST_TEST_EQ(s[i].n, 0);
+    }
+
+    void testPolystore()
+    {
+        polystore ps;
+        auto& c = ps.emplace_per_core<counter>();
+        BOOST_TEST_EQ(&ps.get<per_core<counter>>(), &c);
+        BOOST_TEST_THROWS(ps.emplace_per_core<counter>(),
+            std::invalid_argument);
+        invoke(ps, [](per_core<counter>& pc)
+            {
+                pc.local().n.fetch_add(1);
+            });
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < c.size(); ++i)
+            total += c[i].n.load();
+        BOOST_TEST_EQ(total, 1u);
+    }
+
+    void testMemory()
+    {
+        struct M
+        {
+            std::size_t memory_usage() const noexcept
+            {
+                return 10;
+            }
+        };
+
+        per_core<counter> c(nullptr);
+        BOOST_TEST_GE(c.memory_usage(),
+            c.size() * detail::cache_line_size);
+        per_core<M> m(nullptr);
+        BOOST_TEST_EQ(m.memory_usage(),
+            c.memory_usage() + 10 * m.size());
+
+        polystore ps;
+        ps.emplace_per_core<M>();
+        BOOST_TEST_EQ(ps.get_memory_report()[0].owned,
+            m.memory_usage());
+    }
+
+    void run()
+    {
+        testReplicas();
+        testConstructFailure();
+        testStartStop();
+        testPolystore();
+        testMemory();
+    }
+};
+
+TEST_SUITE(
+    per_core_test,
+    "boost.rts.per_core");
+
+} // rts
+} // boost
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+// Test that header file is self-contained.
+#include <boost/rts/per_thread.hpp>
+
+#include <boost/rts/polystore.hpp>
+
+#include "test_suite.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+// counts live instances and stop calls
+struct tracked
+{
+    std::atomic<int>& live;
+    std::atomic<int>& stops;
+    std::string s;
+
+    tracked(
+        std::atomic<int>& live_,
+        std::atomic<int>& stops_,
+        std::string const& s_)
+        : live(live_)
+        , stops(stops_)
+        , s(s_)
+    {
+        ++live;
+    }
+
+    ~tracked()
+    {
+        --live;
+    }
+
+    void stop()
+    {
+        ++stops;
+    }
+};
+
+struct K
+{
+    int k = 0;
+};
+
+struct L : K
+{
+};
+
+} // (anon)
+
+struct per_thread_test
+{
+    void testLocal()
+    {
+        std::atomic<int> live{0};
+        std::atomic<int> stops{0};
+        {
+            per_thread<tracked> pt(
+                std::ref(live), std::ref(stops), "x");
+            BOOST_TEST_EQ(pt.size(), 0u);
+            auto& a = pt.local();
+            BOOST_TEST_EQ(&pt.local(), &a);
+            BOOST_TEST_EQ(a.s, "x");
+            BOOST_TEST_EQ(pt.size(), 1u);
+
+            // another thread has its own instance,
+            // stopped and destroyed when it exits
+            tracked* b = nullptr;
+            std::thread t([&]
+                {
+                    b = &pt.local();
+                    b->s = "y";
+                    BOOST_TEST_EQ(pt.size(), 2u);
+                });
+            t.join();
+            BOOST_TEST_NE(b, &a);
+            BOOST_TEST_EQ(a.s, "x");
+            BOOST_TEST_EQ(pt.size(), 1u);
+            BOOST_TEST_EQ(live.load(), 1);
+            BOOST_TEST_EQ(stops.load(), 1);
+        }
+        // this thread's instance goes with the container
+        BOOST_TEST_EQ(live.load(), 0);
+        BOOST_TEST_EQ(stops.load(), 2);
+
+        // a new container reusing the id gets new instances
+        std::unique_ptr<per_thread<tracked>> p(new per_thread<
+            tracked>(std::ref(live), std::ref(stops), "1"));
+        BOOST_TEST_EQ(p->local().s, "1");
+        p.reset();
+        p.reset(new per_thread<tracked>(
+            std::ref(live), std::ref(stops), "2"));
+        BOOST_TEST_EQ(p->local().s, "2");
+        BOOST_TEST_EQ(live.load(), 1);
+    }
+
+    void testConstructFailure()
+    {
+        struct X
+        {
+            explicit X(int n)
+            {
+                if(n < 0)
+                    throw std::invalid_argument("");
+            }
+        };
+
+        per_thread<X> pt(-1);
+        BOOST_TEST_THROWS(pt.local(), std::invalid_argument);
+        BOOST_TEST_EQ(pt.size(), 0u);
+    }
+
+    void testPolystore()
+    {
+        std::atomic<int> live{0};
+        std::atomic<int> stops{0};
+        {
+            polystore ps;
+            auto& pt = ps.emplace_thread_local<
+                tracked>(std::ref(live), std::ref(stops), "z");
+            BOOST_TEST_EQ(&ps.get<per_thread<tracked>>(), &pt);
+            BOOST_TEST_THROWS(ps.emplace_thread_local<tracked>(
+                std::ref(live), std::ref(stops), ""),
+                    std::invalid_argument);
+            BOOST_TEST_EQ(live.load(), 0);
+
+            // lookups return the instance of the calling thread
+            auto& a = ps.get<tracked>();
+            BOOST_TEST_EQ(&a, &pt.local());
+            BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(tracked)),
+                static_cast<void*>(&a));
+            tracked* b = nullptr;
+            std::thread t([&]
+                {
+                    invoke(ps, [&b](tracked& x)
+                        {
+                            b = &x;
+                        });
+                    BOOST_TEST_EQ(b, &pt.local());
+                });
+            t.join();
+            BOOST_TEST_NE(b, &a);
+            BOOST_TEST_EQ(live.load(), 1);
+
+            // not an object which can be erased
+            BOOST_TEST_THROWS(ps.erase<tracked>(),
+                std::invalid_argument);
+        }
+        BOOST_TEST_EQ(live.load(), 0);
+        BOOST_TEST_EQ(stops.load(), 2);
+
+        // additional keys
+        polystore ps;
+        ps.emplace_thread_local<L, K>();
+        BOOST_TEST_EQ(ps.find<K>(),
+            static_cast<K*>(&ps.get<L>()));
+        ps.seal();
+        BOOST_TEST_EQ(ps.find<K>(),
+            static_cast<K*>(&ps.get<L>()));
+        BOOST_TEST_THROWS(ps.emplace_thread_local<int>(),
+            std::logic_error);
+    }
+
+    void run()
+    {
+        testLocal();
+        testConstructFailure();
+        testPolystore();
+    }
+};
+
+TEST_SUITE(
+    per_thread_test,
+    "boost.rts.per_thread");
+
+} // rts
+} // boost
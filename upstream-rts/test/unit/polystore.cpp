@@ -11,11 +11,53 @@
 #include <boost/rts/polystore.hpp>
 #include <boost/core/detail/static_assert.hpp>
 
-#include "test_suite.hpp"
+#include "test_helpers.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace boost {
 namespace rts {
 
+namespace {
+
+template<std::size_t I>
+struct many
+{
+    std::size_t i = I;
+};
+
+// Registers and checks many<0> through many<N-1>
+template<std::size_t N>
+struct many_types
+{
+    static void emplace(polystore& ps)
+    {
+        many_types<N - 1>::emplace(ps);
+        ps.emplace<many<N - 1>>();
+    }
+
+    static bool check(polystore const& ps)
+    {
+        auto p = ps.find<many<N - 1>>();
+        return many_types<N - 1>::check(ps) &&
+            p && p->i == N - 1;
+    }
+};
+
+template<>
+struct many_types<0>
+{
+    static void emplace(polystore&) {}
+    static bool check(polystore const&) { return true; }
+};
+
+} // (anon)
+
 struct polystore_test
 {
     void testFind()
@@ -27,6 +69,123 @@ struct polystore_test
         if(! BOOST_TEST_NE(ps.find<T>(), nullptr))
             return;
         BOOST_TEST_EQ(ps.find<T>()->i, 1);
+
+        // type-erased lookup agrees
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(T)),
+            static_cast<void*>(ps.find<T>()));
+
+        // slots are process-wide, contents are not
+        polystore ps2;
+        BOOST_TEST(ps2.find<T>() == nullptr);
+        ps2.use<T>().i = 2;
+        BOOST_TEST_EQ(ps.find<T>()->i, 1);
+        BOOST_TEST_EQ(ps2.find<T>()->i, 2);
+    }
+
+    void testFindMany()
+    {
+        polystore ps;
+        many_types<100>::emplace(ps);
+        BOOST_TEST(many_types<100>::check(ps));
+        BOOST_TEST(ps.find<many<100>>() == nullptr);
+
+        // failed insert leaves the index intact
+        struct K : many<0> {};
+        BOOST_TEST_THROWS((ps.emplace<K, many<0>>()),
+            std::invalid_argument);
+        BOOST_TEST(ps.find<K>() == nullptr);
+        BOOST_TEST(many_types<100>::check(ps));
+    }
+
+    void testSlots()
+    {
+        // slots are numbered across the process
+        polystore big;
+        many_types<200>::emplace(big);
+
+        // a container with a few high slots stays small
+        struct H { int i = 3; };
+        polystore ps;
+        ps.emplace<many<199>>();
+        ps.emplace<H>();
+        ps.emplace<many<0>>();
+        BOOST_TEST_EQ(ps.get<many<199>>().i, 199u);
+        BOOST_TEST_EQ(ps.get<H>().i, 3);
+        BOOST_TEST_EQ(ps.get<many<0>>().i, 0u);
+        BOOST_TEST(ps.find<many<198>>() == nullptr);
+        BOOST_TEST_LT(ps.get_memory_report().index_bytes(),
+            100 * sizeof(void*));
+
+        // erase and relocate reach the high slots
+        ps.erase<many<199>>();
+        BOOST_TEST(ps.find<many<199>>() == nullptr);
+        polystore ps2(std::move(ps));
+        BOOST_TEST_EQ(ps2.get<H>().i, 3);
+        BOOST_TEST(many_types<200>::check(big));
+    }
+
+    void testMove()
+    {
+        struct T { int i = 1; };
+        struct U { int i = 2; };
+
+        polystore ps1;
+        auto& t = ps1.use<T>();
+        polystore ps2(std::move(ps1));
+        BOOST_TEST(ps1.find<T>() == nullptr);
+        BOOST_TEST_EQ(ps2.find<T>(), &t);
+
+        polystore ps3;
+        ps3.use<U>();
+        ps3 = std::move(ps2);
+        BOOST_TEST(ps2.find<T>() == nullptr);
+        BOOST_TEST(ps2.find<U>() == nullptr);
+        BOOST_TEST(ps3.find<U>() == nullptr);
+        BOOST_TEST_EQ(ps3.find<T>(), &t);
+    }
+
+    void testLifetime()
+    {
+        struct T
+        {
+            std::vector<int>& log;
+            int i;
+
+            T(std::vector<int>& log_, int i_)
+                : log(log_), i(i_)
+            {
+            }
+
+            ~T()
+            {
+                log.push_back(i);
+            }
+        };
+
+        // references are stable and objects
+        // are destroyed in reverse order
+        std::vector<int> log;
+        {
+            polystore ps;
+            std::vector<T*> v;
+            std::vector<int*> pod;
+            for(int i = 0; i < 1000; ++i)
+            {
+                v.push_back(&ps.emplace_anon<T>(log, i));
+                // trivially destructible, no element
+                pod.push_back(&ps.emplace_anon<int>(i));
+            }
+            struct big { char buf[100000]; };
+            ps.emplace_anon<big>();
+            for(int i = 0; i < 1000; ++i)
+            {
+                BOOST_TEST_EQ(v[i]->i, i);
+                BOOST_TEST_EQ(*pod[i], i);
+            }
+        }
+        BOOST_TEST_EQ(log.size(), 1000u);
+        for(std::size_t i = 0; i < log.size(); ++i)
+            BOOST_TEST_EQ(log[i], static_cast<int>(999 - i));
     }
 
     void testGet()
@@ -39,6 +198,33 @@ struct polystore_test
         BOOST_TEST_EQ(ps.get<T>().i, 1);
     }
 
+    void testGetAll()
+    {
+        struct A { int i = 1; };
+        struct B { int i = 2; };
+        struct C { int i = 3; };
+        polystore ps;
+        ps.emplace<A>();
+        ps.emplace<B>();
+
+        A* a;
+        B* b;
+        C* c;
+        std::tie(a, b, c) = ps.find_all<A, B, C>();
+        BOOST_TEST_EQ(a, ps.find<A>());
+        BOOST_TEST_EQ(b, ps.find<B>());
+        BOOST_TEST(c == nullptr);
+        BOOST_TEST_THROWS((ps.get_all<A, C>()),
+            std::bad_typeid);
+
+        auto t = ps.get_all<B, A const>();
+        BOOST_TEST_EQ(&std::get<0>(t), b);
+        BOOST_TEST_EQ(&std::get<1>(t), a);
+        BOOST_TEST_EQ(std::get<0>(t).i +
+            std::get<1>(t).i, 3);
+        BOOST_TEST(ps.find_all<>() == std::tuple<>());
+    }
+
     void testEmplaceAnon()
     {
         struct T { int i = 1; };
@@ -210,6 +396,94 @@ struct polystore_test
         }
     }
 
+    void testHandle()
+    {
+        struct T { int t = 1; };
+        struct U : T
+        {
+            using key_type = T;
+            int u = 2;
+        };
+
+        polystore::handle<T> h0;
+        BOOST_TEST(! h0);
+        BOOST_TEST(h0.get() == nullptr);
+
+        polystore ps;
+        polystore::handle<T> h(ps);
+        BOOST_TEST(! h);
+
+        // revalidated after insert
+        auto& u = ps.emplace<U>();
+        BOOST_TEST(h);
+        BOOST_TEST_EQ(h.get(), static_cast<T*>(&u));
+        BOOST_TEST_EQ(h->t, 1);
+        (*h).t = 3;
+        BOOST_TEST_EQ(u.t, 3);
+
+        // revalidated after clear
+        struct store : polystore
+        {
+            using polystore::clear;
+        };
+        store st;
+        st.emplace<U>();
+        store::handle<U> hu(st);
+        BOOST_TEST(hu);
+        st.clear();
+        BOOST_TEST(! hu);
+
+        // revalidated after move
+        polystore ps2(std::move(ps));
+        BOOST_TEST(! h);
+        BOOST_TEST(polystore::handle<T>(ps2));
+    }
+
+    void testSeal()
+    {
+        struct T { int i = 1; };
+        struct U { int i = 2; };
+
+        polystore ps;
+        BOOST_TEST(! ps.is_sealed());
+        many_types<50>::emplace(ps);
+        auto& t = ps.emplace<T>();
+        ps.seal();
+        BOOST_TEST(ps.is_sealed());
+        ps.seal();
+        BOOST_TEST(ps.is_sealed());
+
+        // lookups are unaffected
+        BOOST_TEST(many_types<50>::check(ps));
+        BOOST_TEST_EQ(ps.find<T>(), &t);
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(T)),
+            static_cast<void*>(&t));
+        BOOST_TEST(ps.find(BOOST_CORE_TYPEID(U)) == nullptr);
+        BOOST_TEST(ps.find(BOOST_CORE_TYPEID(
+            many<50>)) == nullptr);
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(
+            many<49>)), static_cast<void*>(
+                ps.find<many<49>>()));
+
+        // existing objects may still be returned
+        BOOST_TEST_EQ(&ps.use<T>(), &t);
+        BOOST_TEST_EQ(&ps.try_emplace<T>(), &t);
+
+        // nothing may be inserted
+        BOOST_TEST_THROWS(ps.emplace<U>(),
+            std::logic_error);
+        BOOST_TEST_THROWS(ps.use<U>(),
+            std::logic_error);
+        BOOST_TEST_THROWS(ps.emplace_anon<U>(),
+            std::logic_error);
+        BOOST_TEST(ps.find<U>() == nullptr);
+
+        // an empty container can be sealed
+        polystore ps2;
+        ps2.seal();
+        BOOST_TEST(ps2.find(BOOST_CORE_TYPEID(T)) == nullptr);
+    }
+
     struct A
     {
         int i = 1;
@@ -286,6 +560,756 @@ struct polystore_test
         return c.d;
     }
 
+    void testErase()
+    {
+        struct T
+        {
+            std::vector<int>& log;
+            int i;
+
+            T(std::vector<int>& log_, int i_)
+                : log(log_), i(i_)
+            {
+            }
+
+            ~T()
+            {
+                log.push_back(i);
+            }
+        };
+        struct K { int k = 0; };
+        struct U : K
+        {
+            using key_type = K;
+            int pad[4] = {};
+        };
+        struct P { char buf[32] = {}; };
+
+        std::vector<int> log;
+        {
+            polystore ps;
+            BOOST_TEST(! ps.erase<U>());
+            ps.emplace<T>(log, 1);
+            auto& u = ps.emplace<U>();
+            ps.emplace<P>();
+            ps.emplace_anon<T>(log, 3);
+
+            // all keys are removed
+            BOOST_TEST_THROWS(ps.erase<K>(),
+                std::invalid_argument);
+            BOOST_TEST(ps.erase<U>());
+            BOOST_TEST(ps.find<U>() == nullptr);
+            BOOST_TEST(ps.find<K>() == nullptr);
+            BOOST_TEST(ps.find(BOOST_CORE_TYPEID(K)) == nullptr);
+            BOOST_TEST(! ps.erase<U>());
+
+            // storage is reused
+            auto& u2 = ps.emplace<U>();
+            BOOST_TEST_EQ(&u2, &u);
+            BOOST_TEST_EQ(ps.find<K>(), &u2);
+
+            // destruction order is kept
+            BOOST_TEST(ps.erase<T>());
+            BOOST_TEST_EQ(log.size(), 1u);
+            BOOST_TEST_EQ(log[0], 1);
+            ps.emplace<T>(log, 4);
+            BOOST_TEST(ps.erase<P>());
+
+            ps.seal();
+            BOOST_TEST_THROWS(ps.erase<T>(),
+                std::logic_error);
+        }
+        BOOST_TEST_EQ(log.size(), 3u);
+        BOOST_TEST_EQ(log[1], 4);
+        BOOST_TEST_EQ(log[2], 3);
+
+        // a child falls back to the parent again
+        polystore parent;
+        parent.emplace<P>();
+        polystore child(&parent);
+        child.emplace<P>();
+        BOOST_TEST(child.erase<P>());
+        BOOST_TEST_EQ(child.find<P>(), parent.find<P>());
+    }
+
+    void testReplace()
+    {
+        struct K { int k = 0; };
+        struct A : K
+        {
+            using key_type = K;
+            int i;
+            explicit A(int i_) noexcept : i(i_) {}
+        };
+        struct B
+        {
+            std::vector<int> v;
+            explicit B(int n)
+            {
+                if(n < 0)
+                    throw std::invalid_argument("n");
+                v.assign(n, n);
+            }
+            B(B&& other) : v(std::move(other.v)) {}
+        };
+
+        polystore ps;
+        BOOST_TEST_THROWS(ps.replace<A>(1), std::bad_typeid);
+        auto& a = ps.emplace<A>(1);
+        auto& b = ps.emplace<B>(1);
+        BOOST_TEST_THROWS(ps.replace<K>(), std::invalid_argument);
+        ps.seal();
+
+        // nothrow move: moved in place
+        auto& a2 = ps.replace<A>(2);
+        BOOST_TEST_EQ(&a2, &a);
+        BOOST_TEST_EQ(ps.get<A>().i, 2);
+        BOOST_TEST_EQ(ps.find<K>(), static_cast<K*>(&a2));
+
+        // move may throw: constructed elsewhere
+        polystore::handle<B> h(ps);
+        auto& b2 = ps.replace<B>(3);
+        BOOST_TEST_EQ(&ps.get<B>(), &b2);
+        BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(B)),
+            static_cast<void*>(&b2));
+        BOOST_TEST_EQ(h.get(), &b2);
+        BOOST_TEST_EQ(b2.v.size(), 3u);
+
+        // strong guarantee
+        BOOST_TEST_THROWS(ps.replace<B>(-1),
+            std::invalid_argument);
+        BOOST_TEST_EQ(&ps.get<B>(), &b2);
+        BOOST_TEST_EQ(b2.v.size(), 3u);
+        (void)b;
+
+        // from the contents of the old object
+        struct S { std::string s; };
+        struct U
+        {
+            std::string s;
+            U(std::string const& s_) : s(s_) {}
+            U(U&& other) : s(std::move(other.s)) {}
+        };
+        polystore ps2;
+        auto& s = ps2.emplace<S>(S{std::string(100, 'x')});
+        auto& s2 = ps2.replace<S>(std::move(ps2.get<S>()));
+        BOOST_TEST_EQ(&s2, &s);
+        BOOST_TEST_EQ(s2.s, std::string(100, 'x'));
+        ps2.replace<S>(S{s2.s + "y"});
+        BOOST_TEST_EQ(ps2.get<S>().s.size(), 101u);
+        ps2.emplace<U>(std::string(100, 'u'));
+        ps2.replace<U>(ps2.get<U>().s);
+        BOOST_TEST_EQ(ps2.get<U>().s, std::string(100, 'u'));
+        ps2.replace<U>(std::move(ps2.get<U>()));
+        BOOST_TEST_EQ(ps2.get<U>().s, std::string(100, 'u'));
+    }
+
+    void testEmplaceAll()
+    {
+        struct T
+        {
+            std::string s = "t";
+        };
+        struct X
+        {
+            X() { throw std::runtime_error(""); }
+        };
+
+        counting_resource mr;
+        {
+            polystore ps(&mr);
+            ps.emplace_all<>();
+            auto t = ps.emplace_all<
+                many<0>, many<1>, many<2>, many<3>,
+                many<4>, many<5>, D, T>();
+            BOOST_TEST_EQ(std::get<0>(t).i, 0u);
+            BOOST_TEST_EQ(&std::get<6>(t), ps.find<D>());
+            BOOST_TEST_EQ(&std::get<6>(t), ps.find<C>());
+            BOOST_TEST_EQ(ps.get<T>().s, "t");
+            BOOST_TEST(many_types<6>::check(ps));
+            // element, index, slot table, and arena
+            BOOST_TEST_LE(mr.calls.load(), 4u);
+
+            // all or nothing
+            BOOST_TEST_THROWS((ps.emplace_all<
+                many<6>, many<7>, X>()),
+                std::runtime_error);
+            BOOST_TEST(ps.find<many<6>>() == nullptr);
+            BOOST_TEST(ps.find<many<7>>() == nullptr);
+            BOOST_TEST_THROWS((ps.emplace_all<
+                many<6>, D>()), std::invalid_argument);
+            BOOST_TEST(ps.find<many<6>>() == nullptr);
+            BOOST_TEST_EQ(ps.get<C>().d, 3.14);
+
+            ps.seal();
+            BOOST_TEST_THROWS(ps.emplace_all<many<6>>(),
+                std::logic_error);
+        }
+        BOOST_TEST_EQ(mr.n.load(), 0u);
+
+        // no growth after reserve
+        {
+            polystore ps(&mr);
+            ps.reserve(3, 3);
+            many_types<3>::emplace(ps);
+            auto const calls = mr.calls.load();
+            ps.emplace<T>();
+            ps.emplace_anon<T>();
+            BOOST_TEST_LE(mr.calls.load(), calls + 1);
+            BOOST_TEST_EQ(ps.get<T>().s, "t");
+        }
+        BOOST_TEST_EQ(mr.n.load(), 0u);
+    }
+
+    void testRegisterFactory()
+    {
+        struct T
+        {
+            std::vector<int>& log;
+            int i;
+
+            T(std::vector<int>& log_, int i_)
+                : log(log_), i(i_)
+            {
+            }
+
+            ~T()
+            {
+                log.push_back(i);
+            }
+        };
+        struct K { int k = 5; };
+        struct U : K
+        {
+            using key_type = K;
+            int pad[4] = {};
+        };
+        struct L : T
+        {
+            L(std::vector<int>& log_, int i_)
+                : T(log_, i_)
+            {
+            }
+        };
+
+        std::vector<int> log;
+        int made = 0;
+        {
+            polystore ps;
+            ps.emplace<T>(log, 1);
+            ps.register_factory<L>(
+                [&](T& t)
+                {
+                    ++made;
+                    return L(t.log, 2);
+                });
+            ps.register_factory<U>([&]
+                {
+                    ++made;
+                    return U();
+                });
+            BOOST_TEST_EQ(made, 0);
+
+            // find doesn't make the object
+            BOOST_TEST(ps.find<K>() == nullptr);
+            BOOST_TEST(ps.find(BOOST_CORE_TYPEID(U)) == nullptr);
+            BOOST_TEST_EQ(made, 0);
+
+            // made on first use, by any key
+            BOOST_TEST_EQ(ps.get<K>().k, 5);
+            BOOST_TEST_EQ(made, 1);
+            BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(U)),
+                static_cast<void*>(ps.find<U>()));
+            BOOST_TEST_EQ(made, 1);
+            BOOST_TEST_EQ(invoke(ps, [](L& l){ return l.i; }), 2);
+            BOOST_TEST_EQ(made, 2);
+            BOOST_TEST_EQ(&ps.try_emplace<L>(log, 3),
+                ps.find<L>());
+            BOOST_TEST_EQ(made, 2);
+            // the temporary, unless it was elided
+            log.clear();
+
+            // keys are taken at registration
+            BOOST_TEST_THROWS(ps.emplace<U>(),
+                std::invalid_argument);
+            BOOST_TEST_THROWS(ps.register_factory<T>([&]
+                {
+                    return T(log, 3);
+                }), std::invalid_argument);
+            BOOST_TEST_THROWS(ps.erase<U>(),
+                std::invalid_argument);
+            BOOST_TEST_THROWS(ps.replace<U>(),
+                std::invalid_argument);
+
+            // a child makes the object in the parent
+            polystore child(&ps);
+            struct M { int i = 7; };
+            ps.register_factory<M>([]{ return M(); });
+            BOOST_TEST_EQ(child.get<M>().i, 7);
+            BOOST_TEST_EQ(child.find<M>(), ps.find<M>());
+
+            ps.seal();
+            BOOST_TEST_EQ(ps.find(BOOST_CORE_TYPEID(M)),
+                static_cast<void*>(ps.find<M>()));
+            BOOST_TEST_THROWS(ps.register_factory<A>(
+                []{ return A(); }), std::logic_error);
+        }
+        // in reverse order of construction
+        BOOST_TEST_EQ(log.size(), 2u);
+        BOOST_TEST_EQ(log[0], 2);
+        BOOST_TEST_EQ(log[1], 1);
+
+        // a made object outlives the objects made after it
+        log.clear();
+        {
+            polystore ps;
+            ps.register_factory<L>([&]{ return L(log, 1); });
+            auto& l = ps.get<L>();
+            ps.emplace<T>(log, l.i + 1);
+        }
+        BOOST_TEST_EQ(log.size(), 2u);
+        BOOST_TEST_EQ(log[0], 2);
+        BOOST_TEST_EQ(log[1], 1);
+
+        // a throwing factory is called again
+        {
+            polystore ps;
+            int n = 0;
+            ps.register_factory<A>([&]
+                {
+                    if(n++ == 0)
+                        throw std::runtime_error("");
+                    return A();
+                });
+            BOOST_TEST_THROWS(ps.get<A>(),
+                std::runtime_error);
+            BOOST_TEST_EQ(ps.get<A>().i, 1);
+            BOOST_TEST_EQ(n, 2);
+        }
+
+        // concurrent first uses make one object
+        {
+            polystore ps;
+            std::atomic<int> n{ 0 };
+            ps.register_factory<A>([&]
+                {
+                    ++n;
+                    return A();
+                });
+            ps.seal();
+            std::atomic<bool> go{ false };
+            std::atomic<int> failed{ 0 };
+            std::vector<std::thread> v;
+            for(int i = 0; i < 8; ++i)
+                v.emplace_back([&]
+                    {
+                        while(! go)
+                            std::this_thread::yield();
+                        auto const p = &ps.get<A>();
+                        if(ps.find(BOOST_CORE_TYPEID(A)) != p ||
+                                ps.find<A>() != p)
+                            ++failed;
+                    });
+            go = true;
+            for(auto& t : v)
+                t.join();
+            BOOST_TEST_EQ(n, 1);
+            BOOST_TEST_EQ(failed, 0);
+        }
+    }
+
+    void testHooks()
+    {
+        struct T { int i = 0; };
+        struct D { std::string s; };
+        struct S
+        {
+            int n = 0;
+            void start() { ++n; }
+        };
+        struct B
+        {
+            std::string s;
+            explicit B(std::string s_) : s(std::move(s_)) {}
+            void start() { s += "+"; }
+            void stop() { s += "-"; }
+        };
+        struct store : polystore
+        {
+            using polystore::get_elements;
+            using polystore::get_hooks;
+        };
+
+        // only objects with start or stop are visited
+        store ps;
+        ps.emplace<T>();
+        ps.emplace<S>();
+        ps.emplace<D>();
+        ps.emplace<B>("b");
+        BOOST_TEST_EQ(ps.get_elements().size(), 2u);
+        auto v = ps.get_hooks();
+        BOOST_TEST_EQ(v.size(), 2u);
+        for(std::size_t i = 0; i < v.size(); ++i)
+            v[i].start();
+        v[1].stop();
+        BOOST_TEST_EQ(ps.get<S>().n, 1);
+        BOOST_TEST_EQ(ps.get<B>().s, "b+-");
+
+        // replace and erase keep the list current
+        auto& b = ps.replace<B>("c");
+        ps.get_hooks()[1].start();
+        BOOST_TEST_EQ(b.s, "c+");
+        BOOST_TEST(ps.erase<S>());
+        BOOST_TEST_EQ(ps.get_hooks().size(), 1u);
+        ps.get_hooks()[0].stop();
+        BOOST_TEST_EQ(b.s, "c+-");
+        BOOST_TEST_EQ(ps.get_elements().size(), 2u);
+
+        // made objects are added when made
+        struct F
+        {
+            std::string s;
+            void stop() { s += "-"; }
+        };
+        ps.register_factory<F>([]{ return F(); });
+        BOOST_TEST_EQ(ps.get_hooks().size(), 1u);
+        auto& f = ps.get<F>();
+        BOOST_TEST_EQ(ps.get_hooks().size(), 2u);
+        BOOST_TEST_EQ(ps.get_elements().size(), 3u);
+        ps.get_hooks()[1].stop();
+        BOOST_TEST_EQ(f.s, "-");
+    }
+
+    void testNoThrow()
+    {
+        struct K { int k = 0; };
+        struct A : K { int i = 1; };
+        struct B { int j = 2; };
+
+        polystore ps;
+        auto r = ps.try_get<A>();
+        BOOST_TEST(r.has_error());
+        BOOST_TEST(r.error() == error::not_found);
+        BOOST_TEST_EQ(r.error().message(), "object not found");
+
+        // duplicates are found before construction
+        auto& a = ps.emplace<A, K>();
+        BOOST_TEST_EQ(&ps.try_get<A>().value(), &a);
+        BOOST_TEST_EQ(&*ps.try_get<K>(), static_cast<K*>(&a));
+        BOOST_TEST(ps.try_emplace_new<A>().error() ==
+            error::duplicate_key);
+        struct C : K
+        {
+            C() { throw std::runtime_error(""); }
+        };
+        BOOST_TEST((ps.try_emplace_new<C, K>().error() ==
+            error::duplicate_key));
+        B b;
+        b.j = 3;
+        auto rb = ps.try_insert(b);
+        BOOST_TEST(rb.has_value());
+        BOOST_TEST_EQ(rb->j, 3);
+        BOOST_TEST(ps.try_insert(b).error() ==
+            error::duplicate_key);
+
+        // missing arguments are not injected
+        auto r1 = try_invoke(ps, [](A& a_, B const& b_)
+            {
+                return a_.i + b_.j;
+            });
+        BOOST_TEST_EQ(r1.value(), 4);
+        int n = 0;
+        auto r2 = try_invoke(ps, [&n](A&, C&) { ++n; });
+        BOOST_TEST(r2.error() == error::not_found);
+        BOOST_TEST_EQ(n, 0);
+        auto r3 = try_invoke(ps, [&n](A&, C* c)
+            {
+                n += c ? 2 : 1;
+            });
+        BOOST_TEST(r3.has_value());
+        BOOST_TEST_EQ(n, 1);
+
+        ps.seal();
+        BOOST_TEST(ps.try_emplace_new<int>().error() ==
+            error::sealed);
+    }
+
+    void testMulti()
+    {
+        struct filter
+        {
+            virtual ~filter() = default;
+            virtual int apply(int) const = 0;
+        };
+        struct named
+        {
+            std::string name;
+        };
+        struct add : filter, named
+        {
+            int n;
+            explicit add(int n_) : n(n_) { name = "add"; }
+            int apply(int i) const override { return i + n; }
+        };
+        struct twice : filter
+        {
+            int apply(int i) const override { return 2 * i; }
+        };
+
+        polystore ps;
+        BOOST_TEST(ps.get_all_of<filter>().empty());
+        auto& a1 = ps.emplace_multi<add, filter, named>(1);
+        ps.emplace_multi<twice, filter>();
+        auto& a2 = ps.emplace_multi<add, filter>(3);
+        BOOST_TEST(ps.find<add>() == nullptr);
+
+        // in order of registration
+        auto const v = ps.get_all_of<filter>();
+        BOOST_TEST_EQ(v.size(), 3u);
+        BOOST_TEST_EQ(v[0], static_cast<filter*>(&a1));
+        BOOST_TEST_EQ(v[2], static_cast<filter*>(&a2));
+        int i = 1;
+        for(auto f : v)
+            i = f->apply(i);
+        BOOST_TEST_EQ(i, 7);
+        auto const n = ps.get_all_of<named>();
+        BOOST_TEST_EQ(n.size(), 1u);
+        BOOST_TEST_EQ(n[0]->name, "add");
+
+        // a child has its own bindings
+        polystore child(&ps);
+        BOOST_TEST_EQ(child.get_all_of<filter>().size(), 3u);
+        child.emplace_multi<twice, filter>();
+        BOOST_TEST_EQ(child.get_all_of<filter>().size(), 1u);
+        BOOST_TEST_EQ(ps.get_all_of<filter>().size(), 3u);
+
+        // strong guarantee
+        struct bad : filter
+        {
+            bad() { throw std::runtime_error(""); }
+            int apply(int i) const override { return i; }
+        };
+        BOOST_TEST_THROWS((ps.emplace_multi<bad, filter>()),
+            std::runtime_error);
+        BOOST_TEST_EQ(ps.get_all_of<filter>().size(), 3u);
+
+        // a failed first binding leaves no list behind
+        struct bad_add : add
+        {
+            bad_add() : add(0) { throw std::runtime_error(""); }
+        };
+        polystore child2(&ps);
+        BOOST_TEST_THROWS((child2.emplace_multi<bad_add, filter, named>()),
+            std::runtime_error);
+        BOOST_TEST_EQ(child2.get_all_of<filter>().size(), 3u);
+        BOOST_TEST_EQ(child2.get_all_of<named>().size(), 1u);
+        child2.emplace_multi<twice, filter>();
+        BOOST_TEST_EQ(child2.get_all_of<filter>().size(), 1u);
+
+        ps.seal();
+        BOOST_TEST_THROWS((ps.emplace_multi<twice, filter>()),
+            std::logic_error);
+        BOOST_TEST_EQ(ps.get_all_of<filter>().size(), 3u);
+    }
+
+    void testStats()
+    {
+#ifdef BOOST_RTS_POLYSTORE_STATS
+        struct A { int i = 1; };
+        struct B {};
+        struct C { int i; };
+
+        // the statistics of T, or all zeroes
+        auto const of = [](
+            polystore const& ps,
+            core::typeinfo const& ti)
+            {
+                for(auto const& e : ps.stats())
+                    if(*e.type == ti)
+                        return e;
+                polystore::key_statistics e{};
+                e.type = &ti;
+                return e;
+            };
+
+        polystore ps;
+        ps.emplace<A>();
+        ps.register_factory<C>([](A& a){ return C{ a.i }; });
+        BOOST_TEST(ps.find<A>() != nullptr);
+        BOOST_TEST(ps.find<A>() != nullptr);
+        BOOST_TEST(ps.find<B>() == nullptr);
+        BOOST_TEST(ps.find(BOOST_CORE_TYPEID(A)) != nullptr);
+        BOOST_TEST_EQ(ps.get<A>().i, 1);
+        BOOST_TEST(! ps.try_get<B>());
+        BOOST_TEST_THROWS(ps.get<B>(), std::bad_typeid);
+        invoke(ps, [](A&, B*){});
+        BOOST_TEST(! try_invoke(ps, [](B&){}));
+        BOOST_TEST_EQ(ps.get<C>().i, 1);
+
+        auto a = of(ps, BOOST_CORE_TYPEID(A));
+        BOOST_TEST_EQ(a.find_hits, 3u);
+        BOOST_TEST_EQ(a.find_misses, 0u);
+        BOOST_TEST_EQ(a.get_hits, 2u);
+        BOOST_TEST_EQ(a.invoke_hits, 1u);
+        BOOST_TEST_EQ(a.constructs, 1u);
+        BOOST_TEST_EQ(a.inserts, 1u);
+        auto b = of(ps, BOOST_CORE_TYPEID(B));
+        BOOST_TEST_EQ(b.find_misses, 1u);
+        BOOST_TEST_EQ(b.get_misses, 2u);
+        BOOST_TEST_EQ(b.invoke_misses, 2u);
+        BOOST_TEST_EQ(b.constructs, 0u);
+        auto c = of(ps, BOOST_CORE_TYPEID(C));
+        BOOST_TEST_EQ(c.get_hits, 1u);
+        BOOST_TEST_EQ(c.constructs, 1u);
+        BOOST_TEST_EQ(c.inserts, 0u);
+
+        // counted by the container looked up
+        polystore child(&ps);
+        BOOST_TEST_EQ(child.get<A>().i, 1);
+        BOOST_TEST_EQ(of(child, BOOST_CORE_TYPEID(A)).get_hits, 1u);
+        BOOST_TEST_EQ(of(ps, BOOST_CORE_TYPEID(A)).get_hits, 2u);
+
+        // concurrent lookups
+        std::vector<std::thread> v;
+        for(int i = 0; i < 4; ++i)
+            v.emplace_back([&ps]
+                {
+                    for(int j = 0; j < 1000; ++j)
+                        ps.find<A>();
+                });
+        for(auto& t : v)
+            t.join();
+        BOOST_TEST_EQ(of(ps, BOOST_CORE_TYPEID(A)).find_hits, 4003u);
+
+        // moved with the objects
+        polystore ps2(std::move(ps));
+        BOOST_TEST_EQ(of(ps2, BOOST_CORE_TYPEID(A)).find_hits, 4003u);
+        BOOST_TEST_EQ(ps.stats().size(), 0u);
+
+        ps2.reset_stats();
+        a = of(ps2, BOOST_CORE_TYPEID(A));
+        BOOST_TEST_EQ(a.find_hits, 0u);
+        BOOST_TEST_EQ(a.constructs, 0u);
+
+        // each lookup of find_all and get_all is counted
+        polystore ps3;
+        ps3.emplace<A>();
+        ps3.find_all<A, B>();
+        BOOST_TEST_EQ(std::get<0>(ps3.get_all<A>()).i, 1);
+        a = of(ps3, BOOST_CORE_TYPEID(A));
+        BOOST_TEST_EQ(a.find_hits, 1u);
+        BOOST_TEST_EQ(a.get_hits, 1u);
+        BOOST_TEST_EQ(of(ps3, BOOST_CORE_TYPEID(B)).find_misses, 1u);
+#endif
+    }
+
+    void testMemory()
+    {
+        struct A { int i = 1; };
+        struct B
+        {
+            std::vector<char> v;
+            B() : v(100) {}
+            std::size_t memory_usage() const noexcept
+            {
+                return v.capacity();
+            }
+        };
+        struct C
+        {
+            std::string s;
+        };
+        struct D { double d = 0; };
+        struct E { char c[64]; };
+
+        BOOST_TEST(detail::has_memory_usage<B>::value);
+        BOOST_TEST(! detail::has_memory_usage<A>::value);
+
+        polystore ps;
+        auto r = ps.get_memory_report();
+        BOOST_TEST_EQ(r.size(), 0u);
+        BOOST_TEST_EQ(r.total_bytes(), 0u);
+
+        ps.emplace<A>();
+        ps.emplace<B>();
+        ps.emplace_anon<C>();
+        ps.register_factory<D>([]{ return D(); });
+        ps.register_factory<E>([]{ return E(); });
+        ps.get<D>();
+
+        // the unmade E, and parents, are not listed
+        polystore child(&ps);
+        BOOST_TEST_EQ(child.get_memory_report().size(), 0u);
+        r = ps.get_memory_report();
+        BOOST_TEST_EQ(r.size(), 4u);
+        std::size_t n = 0;
+        for(auto const& e : r)
+        {
+            if(*e.type == BOOST_CORE_TYPEID(B))
+            {
+                BOOST_TEST_EQ(e.size, sizeof(B));
+                BOOST_TEST_EQ(e.owned, ps.get<B>().v.capacity());
+            }
+            else
+            {
+                BOOST_TEST_EQ(e.owned, 0u);
+            }
+            n += e.size;
+        }
+        BOOST_TEST_EQ(n, sizeof(A) + sizeof(B) +
+            sizeof(C) + sizeof(D));
+        BOOST_TEST_EQ(r.object_bytes(), n);
+        BOOST_TEST_EQ(r.owned_bytes(), ps.get<B>().v.capacity());
+        BOOST_TEST_GE(r.storage_bytes(), n + sizeof(E));
+        BOOST_TEST_EQ(r.overhead_bytes(),
+            r.storage_bytes() - n);
+        BOOST_TEST_GT(r.index_bytes(), 0u);
+        BOOST_TEST_EQ(r.total_bytes(), r.storage_bytes() +
+            r.index_bytes() + r.owned_bytes());
+
+        // interface lists report their vectors
+        struct I { virtual ~I() = default; };
+        struct J : I {};
+        ps.emplace_multi<J, I>();
+        BOOST_TEST_GT(ps.get_memory_report().owned_bytes(),
+            r.owned_bytes());
+
+        // sealing adds the perfect hash
+        auto const before = ps.get_memory_report().index_bytes();
+        ps.seal();
+        BOOST_TEST_GT(ps.get_memory_report().index_bytes(), before);
+    }
+
+    void testResource()
+    {
+        struct T { int i = 1; };
+
+        BOOST_TEST(polystore().resource() == nullptr);
+        counting_resource mr;
+        {
+            polystore ps(&mr);
+            BOOST_TEST_EQ(ps.resource(), &mr);
+            BOOST_TEST_EQ(mr.calls.load(), 0u);
+            many_types<50>::emplace(ps);
+            ps.emplace<T>();
+            ps.seal();
+            BOOST_TEST_GT(mr.n.load(), 0u);
+            auto const calls = mr.calls.load();
+            BOOST_TEST(many_types<50>::check(ps));
+
+            // the resource travels with the contents
+            polystore ps2(std::move(ps));
+            BOOST_TEST_EQ(ps2.resource(), &mr);
+            BOOST_TEST_EQ(ps2.get<T>().i, 1);
+            polystore ps3;
+            ps3 = std::move(ps2);
+            BOOST_TEST_EQ(ps3.resource(), &mr);
+            BOOST_TEST(many_types<50>::check(ps3));
+            BOOST_TEST_EQ(mr.calls.load(), calls);
+        }
+        BOOST_TEST_EQ(mr.n.load(), 0u);
+    }
+
     void testInvoke()
     {
         polystore ps;
@@ -319,10 +1343,27 @@ struct polystore_test
     void run()
     {
         testFind();
+        testFindMany();
+        testSlots();
+        testMove();
+        testLifetime();
         testGet();
+        testGetAll();
         testEmplaceAnon();
         testEmplace();
         testTryEmplace();
+        testHandle();
+        testSeal();
+        testErase();
+        testReplace();
+        testEmplaceAll();
+        testRegisterFactory();
+        testHooks();
+        testNoThrow();
+        testMulti();
+        testStats();
+        testMemory();
+        testResource();
         testInvoke();
     }
 };
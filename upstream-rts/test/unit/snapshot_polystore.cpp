@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+// Test that header file is self-contained.
+#include <boost/rts/snapshot_polystore.hpp>
+
+#include "test_suite.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+struct config
+{
+    int version;
+
+    explicit config(int v)
+        : version(v)
+    {
+    }
+};
+
+struct counted
+{
+    static int live;
+
+    counted() { ++live; }
+    ~counted() { --live; }
+};
+
+int counted::live = 0;
+
+struct B { int i = 2; };
+struct C { int i = 3; };
+struct D : C
+{
+    using key_type = C;
+};
+
+} // (anon)
+
+struct snapshot_polystore_test
+{
+    using editor = snapshot_polystore::editor;
+
+    void testUpdate()
+    {
+        snapshot_polystore sp;
+        auto const s0 = sp.load();
+        BOOST_TEST(s0 != nullptr);
+        BOOST_TEST_EQ(s0->size(), 0u);
+        BOOST_TEST(s0->find<config>() == nullptr);
+
+        sp.update([](editor& e)
+            {
+                e.emplace<config>(1);
+                e.emplace<D>();
+                e.emplace<counted>();
+            });
+        auto const s1 = sp.load();
+        BOOST_TEST_EQ(s1->get<config>().version, 1);
+        BOOST_TEST_EQ(s1->find<C>(), s1->find<D>());
+        BOOST_TEST_EQ(s1->find(BOOST_CORE_TYPEID(C)),
+            static_cast<void*>(s1->find<D>()));
+        BOOST_TEST_EQ(invoke(*s1, [](config const& c, B* b)
+            {
+                return c.version + (b ? 10 : 0);
+            }), 1);
+        BOOST_TEST_EQ(s0->size(), 0u);
+
+        // unchanged objects are shared
+        sp.update([](editor& e)
+            {
+                BOOST_TEST_EQ(e.find<config>()->version, 1);
+                e.replace<config>(2);
+                e.emplace<B>();
+                BOOST_TEST(e.erase<counted>());
+                BOOST_TEST(! e.erase<counted>());
+            });
+        auto const s2 = sp.load();
+        BOOST_TEST_EQ(s1->get<config>().version, 1);
+        BOOST_TEST_EQ(s2->get<config>().version, 2);
+        BOOST_TEST_EQ(s1->find<D>(), s2->find<D>());
+        BOOST_TEST(s2->find<counted>() == nullptr);
+        BOOST_TEST(s1->find<counted>() != nullptr);
+        BOOST_TEST_EQ(counted::live, 1);
+    }
+
+    void testFailure()
+    {
+        snapshot_polystore sp;
+        sp.update([](editor& e)
+            {
+                e.emplace<D>();
+            });
+        auto const s = sp.load();
+
+        // nothing is published
+        BOOST_TEST_THROWS(sp.update([](editor& e)
+            {
+                e.emplace<B>();
+                e.emplace<C>();
+            }), std::invalid_argument);
+        BOOST_TEST_THROWS(sp.update([](editor& e)
+            {
+                e.replace<B>();
+            }), std::bad_typeid);
+        BOOST_TEST_EQ(sp.load(), s);
+        BOOST_TEST(sp.load()->find<B>() == nullptr);
+    }
+
+    void testReload()
+    {
+        snapshot_polystore sp;
+        sp.update([](editor& e)
+            {
+                e.emplace<config>(0);
+            });
+        std::atomic<bool> done{ false };
+        std::atomic<int> failed{ 0 };
+        std::vector<std::thread> v;
+        for(int i = 0; i < 4; ++i)
+            v.emplace_back([&]
+                {
+                    int last = 0;
+                    while(! done)
+                    {
+                        auto const s = sp.load();
+                        int const n = s->get<config>().version;
+                        // versions never go backwards
+                        if(n < last)
+                            ++failed;
+                        last = n;
+                    }
+                });
+        for(int n = 1; n <= 200; ++n)
+            sp.update([n](editor& e)
+                {
+                    e.replace<config>(n);
+                });
+        done = true;
+        for(auto& t : v)
+            t.join();
+        BOOST_TEST_EQ(failed, 0);
+        BOOST_TEST_EQ(sp.load()->get<config>().version, 200);
+    }
+
+    void run()
+    {
+        testUpdate();
+        testFailure();
+        testReload();
+        BOOST_TEST_EQ(counted::live, 0);
+    }
+};
+
+TEST_SUITE(
+    snapshot_polystore_test,
+    "boost.rts.snapshot_polystore");
+
+} // rts
+} // boost
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2025 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/cppalliance/rts
+//
+
+// Test that header file is self-contained.
+#include <boost/rts/static_polystore.hpp>
+
+#include "test_suite.hpp"
+
+#include <string>
+
+namespace boost {
+namespace rts {
+
+namespace {
+
+struct A { int i = 1; };
+struct B { char c = '2'; };
+struct C { double d = 0; };
+struct D : C
+{
+    using key_type = C;
+    D() { d = 3.14; }
+};
+struct E {};
+
+template<int I>
+struct part
+{
+    std::string& log;
+
+    explicit part(std::string& s)
+        : log(s)
+    {
+    }
+
+    ~part()
+    {
+        log += "~" + std::to_string(I);
+    }
+
+    void start()
+    {
+        if(I == 3)
+            throw std::runtime_error("");
+        log += "+" + std::to_string(I);
+    }
+
+    void stop()
+    {
+        log += "-" + std::to_string(I);
+    }
+};
+
+std::string* g_log = nullptr;
+
+template<int I>
+struct logged : part<I>
+{
+    logged() : part<I>(*g_log) {}
+};
+
+} // (anon)
+
+struct static_polystore_test
+{
+    void testGet()
+    {
+        static_polystore<A, B, D> ps;
+        BOOST_TEST_EQ(ps.get<A>().i, 1);
+        BOOST_TEST_EQ(ps.get<B>().c, '2');
+        BOOST_TEST_EQ(ps.get<C>().d, 3.14);
+        BOOST_TEST_EQ(ps.find<C>(), ps.find<D>());
+        BOOST_TEST(ps.find<E>() == nullptr);
+
+        static_polystore<A, B, D> const& cps = ps;
+        cps.get<A>().i = 2;
+        BOOST_TEST_EQ(ps.get<A>().i, 2);
+
+        BOOST_TEST_EQ(invoke(ps, [](A& a, C const& c, E* e)
+            {
+                return a.i + (c.d == 3.14 ? 10 : 0) +
+                    (e ? 100 : 0);
+            }), 12);
+    }
+
+    void testLifetime()
+    {
+        std::string log;
+        g_log = &log;
+        {
+            static_polystore<logged<1>, A, logged<2>> ps;
+            ps.start();
+            ps.stop();
+        }
+        BOOST_TEST_EQ(log, "+1+2-2-1~2~1");
+
+        // started parts are stopped when one throws
+        log.clear();
+        {
+            static_polystore<logged<1>, logged<3>> ps;
+            BOOST_TEST_THROWS(ps.start(),
+                std::runtime_error);
+        }
+        BOOST_TEST_EQ(log, "+1-1~3~1");
+        g_log = nullptr;
+    }
+
+    void testDynamic()
+    {
+        static_polystore<A, D> ps;
+        polystore& dps = ps.dynamic();
+        BOOST_TEST_EQ(&ps.dynamic(), &dps);
+        BOOST_TEST_EQ(dps.find<A>(), ps.find<A>());
+        BOOST_TEST_EQ(dps.find<C>(), ps.find<C>());
+        BOOST_TEST_EQ(dps.find(BOOST_CORE_TYPEID(D)),
+            static_cast<void*>(ps.find<D>()));
+
+        // the view can grow, but not lose the stored objects
+        dps.emplace<B>();
+        BOOST_TEST_EQ(dps.get<B>().c, '2');
+        BOOST_TEST(ps.find<B>() == nullptr);
+        BOOST_TEST_THROWS(dps.emplace<A>(),
+            std::invalid_argument);
+        BOOST_TEST_THROWS(dps.erase<A>(),
+            std::invalid_argument);
+    }
+
+    void run()
+    {
+        testGet();
+        testLifetime();
+        testDynamic();
+    }
+};
+
+TEST_SUITE(
+    static_polystore_test,
+    "boost.rts.static_polystore");
+
+} // rts
+} // boost
@@ -18,9 +18,50 @@
 
 #include "test_suite.hpp"
 
+#include <boost/container/pmr/memory_resource.hpp>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
 namespace boost {
 namespace rts {
 
+// Counts the allocations made through it,
+// and the bytes currently allocated
+struct counting_resource
+    : container::pmr::memory_resource
+{
+    std::atomic<std::size_t> n{0};
+    std::atomic<std::size_t> calls{0};
+
+    void*
+    do_allocate(
+        std::size_t bytes,
+        std::size_t) override
+    {
+        n += bytes;
+        ++calls;
+        return ::operator new(bytes);
+    }
+
+    void
+    do_deallocate(
+        void* p,
+        std::size_t bytes,
+        std::size_t) override
+    {
+        n -= bytes;
+        ::operator delete(p);
+    }
+
+    bool
+    do_is_equal(
+        memory_resource const& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
 } // rts
 } // boost
 